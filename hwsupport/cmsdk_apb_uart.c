@@ -29,6 +29,14 @@ void usart_write(char c)
 	USART->data = (uint32_t) c;
 }
 
+void usart_write_block(const char *s, int n)
+{
+	while (n-- > 0) {
+		while ((USART->state & TX_FULL) != 0) continue;
+		USART->data = (uint32_t) *s++;
+	}
+}
+
 int usart_read(void)
 {
 	while ((USART->state & RX_FULL) == 0) continue;
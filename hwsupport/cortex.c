@@ -55,3 +55,9 @@ void systick_ack()
 {
     uint32_t __attribute__((unused)) dummy = SYSTICK->ctrl & (1 << 16U);
 }
+
+/* Valeur courante du décompteur, utilisée pour mesurer des durées en cycles */
+uint32_t systick_get()
+{
+    return SYSTICK->val;
+}
@@ -27,6 +27,32 @@
     asm volatile("dsb\n" \
                  "nop\n")
 
+#define _DMB() \
+    asm volatile("dmb\n" ::: "memory")
+
+/* Accès exclusifs : _strex retourne 0 si l'écriture a réussi, 1 si la
+ * réservation posée par _ldrex a été perdue (interruption, autre accès).
+ */
+static inline uint32_t _ldrex(volatile uint32_t *addr)
+{
+    uint32_t v;
+    asm volatile("ldrex %0, [%1]" : "=r" (v) : "r" (addr) : "memory");
+    return v;
+}
+
+static inline uint32_t _strex(volatile uint32_t *addr, uint32_t v)
+{
+    uint32_t res;
+    asm volatile("strex %0, %2, [%1]" : "=&r" (res) : "r" (addr), "r" (v)
+                 : "memory");
+    return res;
+}
+
+static inline void _clrex(void)
+{
+    asm volatile("clrex" ::: "memory");
+}
+
 typedef struct _tagSCB {
     volatile uint32_t cpuid;
     volatile uint32_t icsr;
@@ -87,5 +113,6 @@ void systick_start(uint32_t ticks);
 void systick_irq_enable();
 void systick_wait();
 void systick_ack();
+uint32_t systick_get();
 
 #endif /* CORTEX_H_ */
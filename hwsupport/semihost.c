@@ -0,0 +1,55 @@
+/*
+ * semihost.c
+ *
+ *  Entrées/sorties console vers l'hôte par semihosting ARM.
+ */
+
+#include <stdint.h>
+
+#include "semihost.h"
+
+/* Handle de la console hôte (":tt"), ouvert au premier appel */
+static int tt_handle = -2;
+
+static int semihost_call(uint32_t op, void *arg)
+{
+    register uint32_t r0 asm("r0") = op;
+    register void *r1 asm("r1") = arg;
+
+    __asm__ __volatile__("bkpt 0xab" : "+r" (r0) : "r" (r1) : "memory");
+    return (int) r0;
+}
+
+/* Ecrit une chaîne terminée par '\0' en un seul appel */
+void semihost_write0(const char *s)
+{
+    semihost_call(SYS_WRITE0, (void *) s);
+}
+
+/* Ecrit un bloc de n caractères en un seul appel sur la console hôte */
+void semihost_write(const char *s, int n)
+{
+    uint32_t args[3];
+
+    if (tt_handle == -2) {
+        args[0] = (uint32_t) ":tt";
+        args[1] = 4;                    /* mode "w" */
+        args[2] = 3;                    /* longueur du nom */
+        tt_handle = semihost_call(SYS_OPEN, args);
+    }
+    if (tt_handle < 0) {
+        while (n-- > 0) {
+            semihost_call(SYS_WRITEC, (void *) s++);
+        }
+        return;
+    }
+    args[0] = (uint32_t) tt_handle;
+    args[1] = (uint32_t) s;
+    args[2] = (uint32_t) n;
+    semihost_call(SYS_WRITE, args);
+}
+
+int semihost_readc(void)
+{
+    return semihost_call(SYS_READC, 0);
+}
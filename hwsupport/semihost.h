@@ -0,0 +1,25 @@
+/*
+ * semihost.h
+ *
+ *  Entrées/sorties console vers l'hôte par semihosting ARM.
+ *  Nécessite un débogueur ou QEMU lancé avec l'option -semihosting :
+ *  sans hôte, l'instruction bkpt provoque une faute.
+ */
+
+#ifndef SEMIHOST_H_
+#define SEMIHOST_H_
+
+#include <stdint.h>
+
+/* Numéros des opérations semihosting utilisées */
+#define SYS_OPEN   0x01
+#define SYS_WRITEC 0x03
+#define SYS_WRITE0 0x04
+#define SYS_WRITE  0x05
+#define SYS_READC  0x07
+
+void semihost_write0(const char *s);
+void semihost_write(const char *s, int n);
+int semihost_readc(void);
+
+#endif /* SEMIHOST_H_ */
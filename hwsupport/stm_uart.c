@@ -52,6 +52,14 @@ void usart_write(char c)
     USART1->tdr = c;
 }
 
+void usart_write_block(const char *s, int n)
+{
+    while (n-- > 0) {
+        while (!(USART1->isr & (1 << 7))) continue;
+        USART1->tdr = *s++;
+    }
+}
+
 int usart_read()
 {
     while (!(USART1->isr & (1 << 5))) continue;
@@ -12,6 +12,7 @@
 
 void usart_init(uint32_t baudrate);
 void usart_write(char c);
+void usart_write_block(const char *s, int n);
 int usart_read(void);
 
 #endif /* STM_UART_H_ */
@@ -0,0 +1,267 @@
+/*
+ * link.c
+ *
+ *  Multiplexage de plusieurs canaux sur la liaison série unique :
+ *  trames COBS avec numéro de canal et CRC16, une file par canal.
+ */
+
+#include <stdint.h>
+
+#include "link.h"
+#include "../hwsupport/stm32h7xx.h"
+#include "../kernel/noyau_prio.h"
+#include "../kernel/delay.h"
+
+/* Trame en attente d'émission (données brutes, avant encodage) */
+typedef struct {
+    uint8_t len;
+    uint8_t data[LINK_MAX_DATA];
+} LINK_TRAME;
+
+/* File d'émission d'un canal */
+typedef struct {
+    LINK_TRAME trames[LINK_FILE_TAILLE];
+    uint8_t tete;               /* prochaine trame à émettre              */
+    uint8_t taille;             /* nombre de trames en attente            */
+    uint8_t prio;               /* priorité d'émission, 0 la plus forte   */
+    uint8_t politique;          /* LINK_REJETTE_NOUVEAU / LINK_ECRASE_ANCIEN */
+    uint32_t emises;            /* trames émises                          */
+    uint32_t perdues;           /* trames rejetées ou écrasées            */
+} LINK_CANAL;
+
+/* Taille maximale d'une trame encodée : canal + données + CRC, un octet de
+ * surcoût COBS et le délimiteur.
+ */
+#define LINK_TRAME_MAX (1 + LINK_MAX_DATA + 2 + 1 + 1)
+
+static LINK_CANAL _canaux[LINK_NB_CANAUX] = {
+    [LINK_LOG]   = { .prio = 1, .politique = LINK_REJETTE_NOUVEAU },
+    [LINK_TRACE] = { .prio = 2, .politique = LINK_ECRASE_ANCIEN },
+    [LINK_CMD]   = { .prio = 0, .politique = LINK_REJETTE_NOUVEAU },
+    [LINK_STATS] = { .prio = 3, .politique = LINK_ECRASE_ANCIEN },
+};
+
+static volatile uint32_t _emission;     /* 1 pendant l'émission d'une trame */
+static uint8_t _tache_active;           /* link_tache est lancée            */
+
+/* CRC16 CCITT, calculé par quartet */
+static const uint16_t crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+static uint16_t crc16(uint16_t crc, const uint8_t *p, int n)
+{
+    while (n-- > 0) {
+        crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (*p >> 4)];
+        crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (*p & 0x0f)];
+        p++;
+    }
+    return crc;
+}
+
+/* Encodage COBS de n octets (n < 254) ; retourne la taille encodée */
+static int cobs_encode(const uint8_t *src, int n, uint8_t *dst)
+{
+    uint8_t *code = dst;
+    int o = 1;
+
+    *code = 1;
+    while (n-- > 0) {
+        if (*src == 0) {
+            code = &dst[o++];
+            *code = 1;
+        } else {
+            dst[o++] = *src;
+            (*code)++;
+        }
+        src++;
+    }
+    return o;
+}
+
+/* Décodage COBS ; retourne la taille décodée, -1 si la trame est invalide */
+static int cobs_decode(const uint8_t *src, int n, uint8_t *dst, int max)
+{
+    int i = 0, o = 0, code, c;
+
+    while (i < n) {
+        code = c = src[i++];
+        if (c == 0 || i + c - 1 > n || o + c - 1 > max) {
+            return -1;
+        }
+        while (--c > 0) {
+            dst[o++] = src[i++];
+        }
+        /* un bloc court est suivi d'un zéro, sauf en fin de trame */
+        if (code < 0xff && i < n) {
+            if (o == max) {
+                return -1;
+            }
+            dst[o++] = 0;
+        }
+    }
+    return o;
+}
+
+void link_config(uint8_t canal, uint8_t prio, uint8_t politique)
+{
+    _lock_();
+    _canaux[canal].prio = prio;
+    _canaux[canal].politique = politique;
+    _unlock_();
+}
+
+int link_send(uint8_t canal, const void *data, int n)
+{
+    register LINK_CANAL *c = &_canaux[canal];
+    register LINK_TRAME *t;
+    const uint8_t *s = data;
+    int m, acceptes = 0;
+
+    while (n > 0) {
+        m = (n > LINK_MAX_DATA) ? LINK_MAX_DATA : n;
+        _lock_();
+        if (c->taille == LINK_FILE_TAILLE) {
+            c->perdues++;
+            if (c->politique == LINK_REJETTE_NOUVEAU) {
+                _unlock_();
+                break;
+            }
+            c->tete = (c->tete + 1) % LINK_FILE_TAILLE;
+            c->taille--;
+        }
+        t = &c->trames[(c->tete + c->taille) % LINK_FILE_TAILLE];
+        t->len = m;
+        for (int i = 0; i < m; i++) {
+            t->data[i] = s[i];
+        }
+        c->taille++;
+        _unlock_();
+        s += m;
+        n -= m;
+        acceptes += m;
+    }
+
+    if (!_tache_active) {
+        while (link_poll()) continue;
+    }
+    return acceptes;
+}
+
+int link_poll(void)
+{
+    uint8_t brut[1 + LINK_MAX_DATA + 2];
+    uint8_t trame[LINK_TRAME_MAX];
+    register LINK_CANAL *c, *elu = 0;
+    register LINK_TRAME *t;
+    uint16_t crc;
+    int n, canal = 0;
+
+    /* Un seul émetteur à la fois : les octets de deux trames ne doivent
+     * pas se mélanger sur la ligne.
+     */
+    do {
+        if (_ldrex(&_emission)) {
+            _clrex();
+            return 0;
+        }
+    } while (_strex(&_emission, 1));
+
+    _lock_();
+    for (int i = 0; i < LINK_NB_CANAUX; i++) {
+        c = &_canaux[i];
+        if (c->taille && (!elu || c->prio < elu->prio)) {
+            elu = c;
+            canal = i;
+        }
+    }
+    if (elu) {
+        t = &elu->trames[elu->tete];
+        brut[0] = canal;
+        for (n = 0; n < t->len; n++) {
+            brut[1 + n] = t->data[n];
+        }
+        n = 1 + t->len;
+        elu->tete = (elu->tete + 1) % LINK_FILE_TAILLE;
+        elu->taille--;
+        elu->emises++;
+    }
+    _unlock_();
+
+    if (elu) {
+        crc = crc16(0xffff, brut, n);
+        brut[n++] = crc & 0xff;
+        brut[n++] = crc >> 8;
+        n = cobs_encode(brut, n, trame);
+        trame[n++] = 0;
+        usart_write_block((const char *) trame, n);
+    }
+
+    _DMB();
+    _emission = 0;
+    return elu != 0;
+}
+
+int link_lit(uint8_t *canal, uint8_t *data, int max)
+{
+    uint8_t trame[LINK_TRAME_MAX];
+    uint8_t brut[1 + LINK_MAX_DATA + 2];
+    int c, n, i;
+
+    for (;;) {
+        /* Accumule les octets jusqu'au délimiteur */
+        n = 0;
+        while ((c = usart_read()) != 0) {
+            if (n < LINK_TRAME_MAX) {
+                trame[n] = c;
+            }
+            n++;
+        }
+        if (n == 0 || n > LINK_TRAME_MAX) {
+            continue;
+        }
+        n = cobs_decode(trame, n, brut, sizeof(brut));
+        if (n < 3 || crc16(0xffff, brut, n - 2) !=
+                (brut[n - 2] | (brut[n - 1] << 8))) {
+            continue;
+        }
+        n -= 3;
+        if (n > max) {
+            n = max;
+        }
+        *canal = brut[0];
+        for (i = 0; i < n; i++) {
+            data[i] = brut[1 + i];
+        }
+        return n;
+    }
+}
+
+void link_envoie_stats(void)
+{
+    uint8_t stats[LINK_NB_CANAUX * 8];
+    uint32_t v;
+
+    _lock_();
+    for (int i = 0; i < LINK_NB_CANAUX; i++) {
+        for (int j = 0; j < 2; j++) {
+            v = j ? _canaux[i].perdues : _canaux[i].emises;
+            stats[i * 8 + j * 4 + 0] = v;
+            stats[i * 8 + j * 4 + 1] = v >> 8;
+            stats[i * 8 + j * 4 + 2] = v >> 16;
+            stats[i * 8 + j * 4 + 3] = v >> 24;
+        }
+    }
+    _unlock_();
+    link_send(LINK_STATS, stats, sizeof(stats));
+}
+
+void link_tache(void *arg)
+{
+    _tache_active = 1;
+    while (1) {
+        while (link_poll()) continue;
+        delay(1);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * link.h
+ *
+ *  Multiplexage de plusieurs canaux sur la liaison série unique.
+ *
+ *  Chaque message est transmis dans une trame :
+ *      COBS( canal | données (au plus LINK_MAX_DATA octets) | CRC16 ) 0x00
+ *  Le CRC16 (CCITT, polynôme 0x1021, valeur initiale 0xffff) couvre le canal
+ *  et les données ; il est transmis poids faible en premier. L'encodage COBS
+ *  garantit que l'octet 0x00 ne sert que de délimiteur de trame, ce qui
+ *  permet à l'hôte (tools/link_demux.py) de se resynchroniser après une
+ *  perte.
+ */
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include <stdint.h>
+
+/* Canaux de la liaison */
+#define LINK_LOG        0       /* texte de printf / puts                 */
+#define LINK_TRACE      1       /* trace binaire de l'ordonnanceur        */
+#define LINK_CMD        2       /* commandes de l'hôte, réponses          */
+#define LINK_STATS      3       /* instantanés de statistiques            */
+#define LINK_NB_CANAUX  4
+
+/* Taille maximale des données d'une trame */
+#define LINK_MAX_DATA   64
+
+/* Nombre de trames en attente par canal */
+#define LINK_FILE_TAILLE 8
+
+/* Politiques de rejet quand la file d'un canal est pleine */
+#define LINK_REJETTE_NOUVEAU 0  /* la nouvelle trame est perdue           */
+#define LINK_ECRASE_ANCIEN   1  /* la plus ancienne trame est remplacée   */
+
+/* link_config
+ *
+ * Change la priorité d'émission (0 la plus forte) et la politique de rejet
+ * d'un canal. Par défaut : CMD 0, LOG 1, TRACE 2, STATS 3 ; LOG et CMD
+ * rejettent les nouvelles trames, TRACE et STATS écrasent les anciennes.
+ *
+ */
+void link_config(uint8_t canal, uint8_t prio, uint8_t politique);
+
+/* link_send
+ *
+ * Place n octets dans la file du canal, découpés en trames de LINK_MAX_DATA
+ * octets au plus. Ne bloque jamais et peut être appelée en interruption.
+ * Tant que link_tache n'est pas lancée, les trames sont émises aussitôt.
+ * Retourne le nombre d'octets acceptés.
+ *
+ */
+int link_send(uint8_t canal, const void *data, int n);
+
+/* link_poll
+ *
+ * Emet la trame en attente du canal le plus prioritaire.
+ * Retourne 1 si une trame a été émise, 0 sinon.
+ *
+ */
+int link_poll(void);
+
+/* link_lit
+ *
+ * Attend une trame valide de l'hôte et en copie les données (max octets au
+ * plus) dans data. Les trames corrompues sont ignorées.
+ * Retourne le nombre d'octets de données, le canal est rangé dans *canal.
+ *
+ */
+int link_lit(uint8_t *canal, uint8_t *data, int max);
+
+/* link_envoie_stats
+ *
+ * Envoie sur LINK_STATS les compteurs de trames émises et perdues de chaque
+ * canal (deux mots de 32 bits par canal, poids faible en premier).
+ *
+ */
+void link_envoie_stats(void);
+
+/* link_tache
+ *
+ * Tâche d'émission : vide les files à chaque tick. Une fois lancée, les
+ * appels à link_send ne font plus que mettre en file.
+ *
+ */
+void link_tache(void *arg);
+
+#endif /* LINK_H_ */
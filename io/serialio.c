@@ -22,189 +22,523 @@
 
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "serialio.h"
+#include "../kernel/noyau_prio.h"
+#include "../kernel/noyau_file_prio.h"
+#include "../kernel/delay.h"
+#if defined(CONSOLE_SEMIHOSTING)
+#include "../hwsupport/semihost.h"
+#elif defined(CONSOLE_LINK)
+#include "link.h"
+#else
 #include "../hwsupport/stm_uart.h"
+#endif
 
-int getchar(void) {
-  return (usart_read());
+/* Taille du tampon de sortie console utilisé par printf et puts : la chaîne
+ * formatée est envoyée par blocs à l'UART plutôt que caractère par caractère.
+ */
+#define OUT_BUF_LEN 64
+
+/* Destination d'une sortie formatée : la console (tampon local vidé par blocs)
+ * ou une chaîne en mémoire (sprintf, snprintf).
+ */
+typedef struct {
+  int console;            /* 1 : console, 0 : chaîne en mémoire            */
+  char *str;              /* position d'écriture dans la chaîne            */
+  size_t room;            /* place restante dans la chaîne (hors '\0')     */
+  int len;                /* nombre de caractères en attente dans buf      */
+  int pc;                 /* nombre total de caractères produits           */
+  char buf[OUT_BUF_LEN];  /* tampon console                                */
+} out_t;
+
+#if defined(CONSOLE_SEMIHOSTING)
+/* Ecrit un bloc sur la console de l'hôte en un seul appel semihosting */
+static void console_emet(const char *s, int n) {
+  semihost_write(s, n);
+}
+#elif defined(CONSOLE_LINK)
+/* Ecrit un bloc dans le canal texte de la liaison multiplexée */
+static void console_emet(const char *s, int n) {
+  link_send(LINK_LOG, s, n);
 }
+#else
+/* Ecrit un bloc sur la console en convertissant '\n' en "\r\n" */
+static void console_emet(const char *s, int n) {
+  const char *end = s + n;
+  const char *p;
 
-int putchar(int c) {
-  if (c == '\n') usart_write('\r');
-  usart_write(c);
-  return ((unsigned char) c);
+  while (s < end) {
+    for (p = s; p < end && *p != '\n'; ++p)
+      continue;
+    if (p > s)
+      usart_write_block(s, p - s);
+    if (p < end) {
+      usart_write_block("\r\n", 2);
+      ++p;
+    }
+    s = p;
+  }
 }
+#endif
 
-int puts(const char *s) {
-  while (*s) {
-    putchar(*(s++));
+/* Sortie tamponnée par tâche (voir console_tache) : chaque tâche remplit son
+ * propre tampon de ligne ; les lignes complètes sont recopiées d'un bloc,
+ * sous verrou court, dans une file partagée vidée par une tâche de faible
+ * priorité. Une tâche ne bloque donc jamais sur l'UART et les lignes de
+ * plusieurs tâches ne se mélangent pas. Si la file est pleine, la ligne est
+ * perdue et comptée.
+ */
+#define CONSOLE_LIGNE 96        /* tampon de ligne d'une tâche           */
+#define CONSOLE_FILE 2048       /* file partagée, puissance de 2         */
+
+static char _lignes[MAX_TACHES_NOYAU][CONSOLE_LIGNE];
+static uint8_t _lignes_len[MAX_TACHES_NOYAU];
+static char _sortie[CONSOLE_FILE];
+static uint32_t _sortie_tete;   /* index d'écriture (croît sans fin)     */
+static uint32_t _sortie_queue;  /* index de lecture (croît sans fin)     */
+static uint32_t _sortie_perdus; /* lignes perdues faute de place         */
+static volatile uint8_t _console_tamponnee;
+
+/* Ajoute un bloc entier à la file partagée, ou le perd s'il n'y tient pas */
+static void sortie_ajoute(const char *s, int n) {
+  _lock_();
+  if (CONSOLE_FILE - (_sortie_tete - _sortie_queue) < (uint32_t) n) {
+    _sortie_perdus++;
+  } else {
+    while (n-- > 0)
+      _sortie[_sortie_tete++ & (CONSOLE_FILE - 1)] = *s++;
   }
-  return (putchar('\n'));
+  _unlock_();
 }
 
-static void printchar(char **str, int c) {
-  if (str) {
-    **str = c;
-    ++(*str);
-  } else
-    (void) putchar(c);
+/* Retire au plus n caractères de la file partagée */
+static int sortie_retire(char *s, int n) {
+  int m = 0;
+
+  _lock_();
+  while (m < n && _sortie_queue != _sortie_tete)
+    s[m++] = _sortie[_sortie_queue++ & (CONSOLE_FILE - 1)];
+  _unlock_();
+  return m;
 }
 
-#define PAD_RIGHT 1
-#define PAD_ZERO 2
+static int en_interruption(void) {
+  uint32_t ipsr;
+
+  __asm__ __volatile__("mrs %0, ipsr" : "=r" (ipsr));
+  return ipsr != 0;
+}
+
+static void console_write(const char *s, int n) {
+  register char *ligne;
+  register uint8_t *len;
+  uint16_t t;
 
-static int prints(char **out, const char *string, int width, int pad) {
-  register int pc = 0, padchar = ' ';
-
-  if (width > 0) {
-    register int len = 0;
-    register const char *ptr;
-    for (ptr = string; *ptr; ++ptr)
-      ++len;
-    if (len >= width)
-      width = 0;
-    else
-      width -= len;
-    if (pad & PAD_ZERO)
-      padchar = '0';
-  }
-  if (!(pad & PAD_RIGHT)) {
-    for (; width > 0; --width) {
-      printchar(out, padchar);
-      ++pc;
+  if (!_console_tamponnee) {
+    console_emet(s, n);
+    return;
+  }
+  /* En interruption, le bloc part directement dans la file partagée */
+  if (en_interruption()) {
+    sortie_ajoute(s, n);
+    return;
+  }
+  t = noyau_get_tc();
+  ligne = _lignes[t];
+  len = &_lignes_len[t];
+  while (n-- > 0) {
+    ligne[(*len)++] = *s;
+    if (*s++ == '\n' || *len == CONSOLE_LIGNE) {
+      sortie_ajoute(ligne, *len);
+      *len = 0;
     }
   }
-  for (; *string; ++string) {
-    printchar(out, *string);
-    ++pc;
+}
+
+static void out_flush(out_t *o) {
+  if (o->console && o->len) {
+    console_write(o->buf, o->len);
+    o->len = 0;
   }
-  for (; width > 0; --width) {
-    printchar(out, padchar);
-    ++pc;
+}
+
+static void out_block(out_t *o, const char *s, int n) {
+  register int m;
+
+  o->pc += n;
+  if (!o->console) {
+    m = ((size_t) n < o->room) ? n : (int) o->room;
+    o->room -= m;
+    while (m-- > 0)
+      *o->str++ = *s++;
+    return;
+  }
+  /* Les blocs plus grands que le tampon partent directement */
+  if (n >= OUT_BUF_LEN) {
+    out_flush(o);
+    console_write(s, n);
+    return;
   }
+  while (n > 0) {
+    m = OUT_BUF_LEN - o->len;
+    if (m > n)
+      m = n;
+    n -= m;
+    while (m-- > 0)
+      o->buf[o->len++] = *s++;
+    if (o->len == OUT_BUF_LEN)
+      out_flush(o);
+  }
+}
 
-  return pc;
+static void out_fill(out_t *o, char c, int n) {
+  static const char spaces[] = "                ";
+  static const char zeros[] = "0000000000000000";
+  const char *s = (c == '0') ? zeros : spaces;
+
+  for (; n > 16; n -= 16)
+    out_block(o, s, 16);
+  if (n > 0)
+    out_block(o, s, n);
 }
 
-/* the following should be enough for 32 bit int */
-#define PRINT_BUF_LEN 12
+static void out_init_console(out_t *o) {
+  o->console = 1;
+  o->str = 0;
+  o->room = 0;
+  o->len = 0;
+  o->pc = 0;
+}
 
-static int printi(char **out, int i, int b, int sg, int width, int pad,
-    int letbase) {
-  char print_buf[PRINT_BUF_LEN];
-  char *s;
-  int t, neg = 0, pc = 0;
-  unsigned int u = i;
+static void out_init_str(out_t *o, char *out, size_t n) {
+  o->console = 0;
+  o->str = out;
+  o->room = n ? n - 1 : 0;
+  o->len = 0;
+  o->pc = 0;
+}
 
-  if (i == 0) {
-    print_buf[0] = '0';
-    print_buf[1] = '\0';
-    return prints(out, print_buf, width, pad);
+void console_flush(void) {
+  uint16_t t;
+
+  if (_console_tamponnee && !en_interruption()) {
+    t = noyau_get_tc();
+    if (_lignes_len[t]) {
+      sortie_ajoute(_lignes[t], _lignes_len[t]);
+      _lignes_len[t] = 0;
+    }
   }
+}
 
-  if (sg && b == 10 && i < 0) {
-    neg = 1;
-    u = -i;
+void console_direct(void) {
+  char bloc[OUT_BUF_LEN];
+  int n;
+
+  _console_tamponnee = 0;
+  while ((n = sortie_retire(bloc, sizeof(bloc))) > 0)
+    console_emet(bloc, n);
+}
+
+void console_tache(void *arg) {
+  char bloc[OUT_BUF_LEN];
+  int n;
+
+  _console_tamponnee = 1;
+  while (1) {
+    while ((n = sortie_retire(bloc, sizeof(bloc))) > 0)
+      console_emet(bloc, n);
+    delay(1);
   }
+}
 
-  s = print_buf + PRINT_BUF_LEN - 1;
-  *s = '\0';
+int getchar(void) {
+#if defined(CONSOLE_SEMIHOSTING)
+  return (semihost_readc());
+#elif defined(CONSOLE_LINK)
+  /* Les caractères proviennent des trames du canal de commande */
+  static uint8_t cmd[LINK_MAX_DATA];
+  static int cmd_len, cmd_pos;
+  uint8_t canal;
 
-  while (u) {
-    t = u % b;
-    if (t >= 10)
-      t += letbase - '0' - 10;
-    *--s = t + '0';
-    u /= b;
+  while (cmd_pos == cmd_len) {
+    cmd_len = link_lit(&canal, cmd, sizeof(cmd));
+    cmd_pos = 0;
+    if (canal != LINK_CMD)
+      cmd_len = 0;
   }
+  return (cmd[cmd_pos++]);
+#else
+  return (usart_read());
+#endif
+}
 
-  if (neg) {
-    if (width && (pad & PAD_ZERO)) {
-      printchar(out, '-');
-      ++pc;
-      --width;
-    } else {
-      *--s = '-';
-    }
+int putchar(int c) {
+  char ch = c;
+
+  console_write(&ch, 1);
+  return ((unsigned char) c);
+}
+
+int puts(const char *s) {
+  out_t o;
+  const char *p;
+
+  out_init_console(&o);
+  for (p = s; *p; ++p)
+    continue;
+  out_block(&o, s, p - s);
+  out_block(&o, "\n", 1);
+  out_flush(&o);
+  return ('\n');
+}
+
+#define PAD_RIGHT 1
+#define PAD_ZERO 2
+
+/* Ecrit un champ : préfixe (signe, "0x"), puis les caractères s, cadrés sur
+ * width selon pad. Le remplissage par des zéros se place après le préfixe.
+ */
+static void out_field(out_t *o, const char *prefix, int plen, const char *s,
+    int n, int width, int pad) {
+  register int fill = width - plen - n;
+
+  if (fill > 0 && !(pad & (PAD_RIGHT | PAD_ZERO))) {
+    out_fill(o, ' ', fill);
+    fill = 0;
+  }
+  if (plen)
+    out_block(o, prefix, plen);
+  if (fill > 0 && !(pad & PAD_RIGHT)) {
+    out_fill(o, '0', fill);
+    fill = 0;
   }
+  out_block(o, s, n);
+  if (fill > 0)
+    out_fill(o, ' ', fill);
+}
+
+/* the following should be enough for 64 bit int */
+#define PRINT_BUF_LEN 24
+
+/* Table des paires de chiffres décimaux : deux chiffres par division */
+static const char digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
 
-  return pc + prints(out, s, width, pad);
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+/* Conversion décimale d'un entier 32 bits, écrite en partant de la fin du
+ * tampon. La division par la constante 100 est remplacée par le compilateur
+ * par une multiplication.
+ */
+static char *utoa10(char *s, uint32_t u) {
+  register const char *d;
+  register uint32_t q;
+
+  while (u >= 100) {
+    q = u / 100;
+    d = &digit_pairs[(u - q * 100) * 2];
+    *--s = d[1];
+    *--s = d[0];
+    u = q;
+  }
+  if (u >= 10) {
+    d = &digit_pairs[u * 2];
+    *--s = d[1];
+    *--s = d[0];
+  } else {
+    *--s = '0' + u;
+  }
+  return s;
 }
 
-static int print(char **out, const char *format, va_list args) {
-  int width, pad;
-  int pc = 0;
-  char scr[2];
+/* Conversion décimale d'un entier 64 bits : les tranches de 9 chiffres de
+ * poids faible sont extraites une à une, le reste suit le chemin 32 bits.
+ */
+static char *ulltoa10(char *s, unsigned long long u) {
+  unsigned long long q;
+  uint32_t r;
+  char *e;
+
+  while (u > 0xffffffffULL) {
+    q = u / 1000000000ULL;
+    r = (uint32_t) (u - q * 1000000000ULL);
+    e = s - 9;
+    s = utoa10(s, r);
+    while (s > e)
+      *--s = '0';
+    u = q;
+  }
+  return utoa10(s, (uint32_t) u);
+}
+
+/* Conversion hexadécimale sans division : un chiffre par quartet */
+static char *ulltoa16(char *s, unsigned long long u, const char *digits,
+    int min) {
+  register uint32_t w = (uint32_t) u;
+  register uint32_t h = (uint32_t) (u >> 32);
+  char *e = s - min;
+
+  do {
+    *--s = digits[w & 0xf];
+    w >>= 4;
+    if (h) {
+      w |= (h & 0xf) << 28;
+      h >>= 4;
+    }
+  } while (w | h);
+  while (s > e)
+    *--s = '0';
+  return s;
+}
 
-  for (; *format != 0; ++format) {
+static int print(out_t *o, const char *format, va_list args) {
+  register const char *p;
+  int width, pad, lng;
+  unsigned long long u;
+  long long v;
+  char print_buf[PRINT_BUF_LEN];
+  char *end = print_buf + PRINT_BUF_LEN;
+  char *s;
+  char c;
+
+  for (;;) {
+    /* Les portions littérales sont copiées en un seul bloc */
+    for (p = format; *p && *p != '%'; ++p)
+      continue;
+    if (p != format)
+      out_block(o, format, p - format);
+    if (*p == '\0')
+      break;
+    format = p + 1;
+    width = pad = lng = 0;
+    if (*format == '\0')
+      break;
     if (*format == '%') {
+      out_block(o, format++, 1);
+      continue;
+    }
+    if (*format == '-') {
       ++format;
-      width = pad = 0;
-      if (*format == '\0')
-        break;
-      if (*format == '%')
-        goto out;
-      if (*format == '-') {
-        ++format;
-        pad = PAD_RIGHT;
-      }
-      while (*format == '0') {
-        ++format;
-        pad |= PAD_ZERO;
-      }
-      for (; *format >= '0' && *format <= '9'; ++format) {
-        width *= 10;
-        width += *format - '0';
-      }
-      if (*format == 's') {
-        register char *s = (char *) va_arg( args, int );
-        pc += prints(out, s ? s : "(null)", width, pad);
-        continue;
-      }
-      if (*format == 'd') {
-        pc += printi(out, va_arg( args, int ), 10, 1, width, pad, 'a');
-        continue;
-      }
-      if (*format == 'x') {
-        pc += printi(out, va_arg( args, int ), 16, 0, width, pad, 'a');
-        continue;
-      }
-      if (*format == 'X') {
-        pc += printi(out, va_arg( args, int ), 16, 0, width, pad, 'A');
-        continue;
-      }
-      if (*format == 'u') {
-        pc += printi(out, va_arg( args, int ), 10, 0, width, pad, 'a');
-        continue;
-      }
-      if (*format == 'c') {
-        /* char are converted to int then pushed on the stack */
-        scr[0] = (char) va_arg( args, int );
-        scr[1] = '\0';
-        pc += prints(out, scr, width, pad);
+      pad = PAD_RIGHT;
+    }
+    while (*format == '0') {
+      ++format;
+      pad |= PAD_ZERO;
+    }
+    for (; *format >= '0' && *format <= '9'; ++format) {
+      width *= 10;
+      width += *format - '0';
+    }
+    while (*format == 'l') {
+      ++format;
+      ++lng;
+    }
+    if (*format == '\0')
+      break;
+
+    switch (c = *format++) {
+    case 's':
+      s = va_arg(args, char *);
+      if (!s)
+        s = "(null)";
+      for (p = s; *p; ++p)
         continue;
-      }
-    } else {
-      out: printchar(out, *format);
-      ++pc;
+      out_field(o, 0, 0, s, p - s, width, pad);
+      break;
+    case 'c':
+      /* char are converted to int then pushed on the stack */
+      c = (char) va_arg(args, int);
+      out_field(o, 0, 0, &c, 1, width, pad);
+      break;
+    case 'd':
+      if (lng > 1)
+        v = va_arg(args, long long);
+      else if (lng)
+        v = va_arg(args, long);
+      else
+        v = va_arg(args, int);
+      u = (v < 0) ? -(unsigned long long) v : (unsigned long long) v;
+      s = (u >> 32) ? ulltoa10(end, u) : utoa10(end, (uint32_t) u);
+      out_field(o, "-", v < 0, s, end - s, width, pad);
+      break;
+    case 'u':
+      if (lng > 1)
+        u = va_arg(args, unsigned long long);
+      else if (lng)
+        u = va_arg(args, unsigned long);
+      else
+        u = va_arg(args, unsigned int);
+      s = (u >> 32) ? ulltoa10(end, u) : utoa10(end, (uint32_t) u);
+      out_field(o, 0, 0, s, end - s, width, pad);
+      break;
+    case 'x':
+    case 'X':
+      if (lng > 1)
+        u = va_arg(args, unsigned long long);
+      else if (lng)
+        u = va_arg(args, unsigned long);
+      else
+        u = va_arg(args, unsigned int);
+      s = ulltoa16(end, u, (c == 'x') ? hex_lower : hex_upper, 1);
+      out_field(o, 0, 0, s, end - s, width, pad);
+      break;
+    case 'p':
+      u = (uintptr_t) va_arg(args, void *);
+      s = ulltoa16(end, u, hex_lower, 2 * sizeof(void *));
+      out_field(o, "0x", 2, s, end - s, width, pad);
+      break;
+    default:
+      break;
     }
   }
-  if (out)
-    **out = '\0';
-  va_end( args);
-  return pc;
+  return o->pc;
 }
 
 int printf(const char *format, ...) {
   va_list args;
+  out_t o;
+
+  va_start(args, format);
+  out_init_console(&o);
+  print(&o, format, args);
+  out_flush(&o);
+  va_end(args);
+  return o.pc;
+}
+
+int vsnprintf(char *out, size_t n, const char *format, va_list args) {
+  out_t o;
 
-  va_start( args, format);
-  return print(0, format, args);
+  out_init_str(&o, out, n);
+  print(&o, format, args);
+  if (n)
+    *o.str = '\0';
+  return o.pc;
+}
+
+int snprintf(char *out, size_t n, const char *format, ...) {
+  va_list args;
+  int pc;
+
+  va_start(args, format);
+  pc = vsnprintf(out, n, format, args);
+  va_end(args);
+  return pc;
 }
 
 int sprintf(char *out, const char *format, ...) {
   va_list args;
+  int pc;
 
-  va_start( args, format);
-  return print(&out, format, args);
+  va_start(args, format);
+  pc = vsnprintf(out, (size_t) -1, format, args);
+  va_end(args);
+  return pc;
 }
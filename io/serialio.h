@@ -19,16 +19,43 @@
 #define SERIALIO_H_
 
 #include <stdarg.h>
+#include <stddef.h>
 
+/* La console utilise l'UART par défaut. Compilé avec -DCONSOLE_SEMIHOSTING,
+ * elle passe par le semihosting (QEMU -semihosting, sonde de débogage) :
+ * chaque bloc formaté est transmis à l'hôte en un seul appel.
+ * Compilé avec -DCONSOLE_LINK, la sortie part sur le canal LINK_LOG de la
+ * liaison multiplexée (link.h) et getchar lit le canal LINK_CMD.
+ */
+
+/* console_tache
+ *
+ * Tâche de vidage de la console, à créer avec une priorité basse. Une fois
+ * lancée, chaque tâche écrit dans son propre tampon de ligne et seules des
+ * lignes complètes passent, d'un bloc, dans une file partagée que cette tâche
+ * envoie sur la console. Les écritures ne bloquent jamais ; si la file est
+ * pleine, la ligne est perdue.
+ * console_flush envoie la ligne incomplète de la tâche courante.
+ * console_direct vide la file et repasse en écriture directe (sortie du
+ * noyau).
+ */
+void console_tache(void *arg);
+void console_flush(void);
+void console_direct(void);
 
 int getchar(void);
 int putchar(int c);
 int puts(const char *s);
 
-/* printf et sprintf supportent les formats s, d, x, X, u et c et les options
+/* printf, sprintf et snprintf supportent les formats s, d, x, X, u, c et p,
+ * les modificateurs de longueur l (32 bits) et ll (64 bits) et les options
  * de padding associées.
+ * snprintf et vsnprintf n'écrivent jamais plus de n caractères ('\0' compris)
+ * et retournent la longueur qu'aurait eue la chaîne complète.
  */
 int printf(const char *format, ...);
 int sprintf(char *out, const char *format, ...);
+int snprintf(char *out, size_t n, const char *format, ...);
+int vsnprintf(char *out, size_t n, const char *format, va_list args);
 
 #endif /* SERIALIO_H_ */
@@ -0,0 +1,169 @@
+/*----------------------------------------------------------------------------*
+ * fichier : anneau.c                                                         *
+ * tampon circulaire sans verrou, un producteur et un consommateur            *
+ *----------------------------------------------------------------------------*/
+
+#include "anneau.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "notify.h"
+#include "../hwsupport/stm32h7xx.h"
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * copie de n octets, par mots quand la taille et les adresses le permettent
+ */
+static void anneau_copie(void *d, const void *s, uint32_t n) {
+	if (((n | (uint32_t) d | (uint32_t) s) & 3) == 0) {
+		register uint32_t *dw = d;
+		register const uint32_t *sw = s;
+		for (n >>= 2; n; n--) {
+			*dw++ = *sw++;
+		}
+	} else {
+		register uint8_t *db = d;
+		register const uint8_t *sb = s;
+		while (n--) {
+			*db++ = *sb++;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+int anneau_init(ANNEAU *r, void *stockage, uint16_t taille, uint32_t capacite) {
+	if (capacite == 0 || (capacite & (capacite - 1)) != 0) {
+		return 0;
+	}
+	r->stockage = stockage;
+	r->masque = capacite - 1;
+	r->taille = taille;
+	r->tache = MAX_TACHES_NOYAU;
+	r->ecr = 0;
+	r->lec = 0;
+	return 1;
+}
+
+void anneau_reveil(ANNEAU *r, uint16_t tache) {
+	r->tache = tache;
+}
+
+/*
+ * attend que l'anneau contienne au moins un element
+ * entre  : anneau, delai maximal en ticks
+ * sortie : ATT_OK ou ATT_TIMEOUT
+ * description : a appeler par la tache donnee a anneau_reveil ; la
+ *               notification est memorisee, un element publie entre le test
+ *               et l'attente n'est donc pas manque
+ */
+uint8_t anneau_attend(ANNEAU *r, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint32_t delai = timeout;
+	int32_t reste;
+
+	while (r->ecr == r->lec) {
+		// une notification sans element ne prolonge pas l'attente
+		if (timeout != ATT_INFINI) {
+			reste = (int32_t) (echeance - noyau_get_ticks());
+			if (reste <= 0) {
+				return ATT_TIMEOUT;
+			}
+			delai = reste;
+		}
+		if (notify_wait(0, delai, 0) != ATT_OK) {
+			return (r->ecr == r->lec) ? ATT_TIMEOUT : ATT_OK;
+		}
+	}
+	return ATT_OK;
+}
+
+uint32_t anneau_nb(ANNEAU *r) {
+	return r->ecr - r->lec;
+}
+
+uint32_t anneau_zone_ecriture(ANNEAU *r, void **zone) {
+	uint32_t ecr = r->ecr;
+	uint32_t i = ecr & r->masque;
+	uint32_t libres = r->masque + 1 - (ecr - r->lec);
+	uint32_t jusqua_fin = r->masque + 1 - i;
+
+	*zone = r->stockage + i * r->taille;
+	return (libres < jusqua_fin) ? libres : jusqua_fin;
+}
+
+/*
+ * publie n elements ecrits dans la zone d'ecriture
+ * description : la barriere garantit que le consommateur voit les donnees
+ *               avant le nouvel index
+ */
+void anneau_publie(ANNEAU *r, uint32_t n) {
+	uint32_t ecr = r->ecr;
+
+	_DMB();
+	r->ecr = ecr + n;
+	if (n && r->tache != MAX_TACHES_NOYAU && ecr == r->lec) {
+		notify(r->tache, 0, NOTIF_SIGNAL);
+	}
+}
+
+uint32_t anneau_zone_lecture(ANNEAU *r, const void **zone) {
+	uint32_t lec = r->lec;
+	uint32_t i = lec & r->masque;
+	uint32_t presents = r->ecr - lec;
+	uint32_t jusqua_fin = r->masque + 1 - i;
+
+	_DMB();		/* les donnees sont lues apres l'index du producteur */
+	*zone = r->stockage + i * r->taille;
+	return (presents < jusqua_fin) ? presents : jusqua_fin;
+}
+
+/*
+ * rend n elements lus au producteur
+ * description : la barriere garantit que les lectures sont terminees avant
+ *               que le producteur puisse reecrire les cases
+ */
+void anneau_libere(ANNEAU *r, uint32_t n) {
+	_DMB();
+	r->lec += n;
+}
+
+uint32_t anneau_ecrit(ANNEAU *r, const void *elems, uint32_t n) {
+	const uint8_t *s = elems;
+	uint32_t total = 0, m;
+	void *zone;
+
+	/* au plus deux zones : jusqu'a la fin du tableau, puis depuis le debut */
+	while (total < n && (m = anneau_zone_ecriture(r, &zone)) != 0) {
+		if (m > n - total) {
+			m = n - total;
+		}
+		anneau_copie(zone, s, m * r->taille);
+		s += m * r->taille;
+		total += m;
+		anneau_publie(r, m);
+	}
+	return total;
+}
+
+uint32_t anneau_lit(ANNEAU *r, void *elems, uint32_t n) {
+	uint8_t *d = elems;
+	uint32_t total = 0, m;
+	const void *zone;
+
+	while (total < n && (m = anneau_zone_lecture(r, &zone)) != 0) {
+		if (m > n - total) {
+			m = n - total;
+		}
+		anneau_copie(d, zone, m * r->taille);
+		d += m * r->taille;
+		total += m;
+		anneau_libere(r, m);
+	}
+	return total;
+}
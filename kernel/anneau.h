@@ -0,0 +1,75 @@
+/*----------------------------------------------------------------------------*
+ * fichier : anneau.h                                                         *
+ * tampon circulaire sans verrou, un producteur et un consommateur            *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __ANNEAU_H__
+#define __ANNEAU_H__
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant un anneau
+ * un seul producteur (tache ou interruption) et un seul consommateur : le
+ * producteur n'ecrit que ecr, le consommateur que lec. Les index courent
+ * librement et sont ramenes dans le tableau par masque ; aucune section
+ * critique, seulement des barrieres memoire.
+ */
+typedef struct {
+    uint8_t *stockage;          // zone de capacite * taille octets
+    uint32_t masque;            // capacite - 1, capacite puissance de 2
+    uint16_t taille;            // taille d'un element en octets
+    uint16_t tache;             // tache notifiee au passage vide -> non vide
+    volatile uint32_t ecr;      // nombre d'elements ecrits depuis l'origine
+    volatile uint32_t lec;      // nombre d'elements lus depuis l'origine
+} ANNEAU;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un anneau
+ * entre  : anneau, zone de stockage, taille d'un element, capacite en
+ *          elements (puissance de 2)
+ * sortie : 0 si la capacite n'est pas une puissance de 2, 1 sinon
+ */
+int anneau_init(ANNEAU *r, void *stockage, uint16_t taille, uint32_t capacite);
+
+/*
+ * reveil optionnel : quand l'anneau passe de vide a non vide, le
+ * producteur notifie la tache (notify, NOTIF_SIGNAL), qui attend par
+ * anneau_attend. MAX_TACHES_NOYAU (valeur initiale) : pas de reveil.
+ */
+void anneau_reveil(ANNEAU *r, uint16_t tache);
+uint8_t anneau_attend(ANNEAU *r, uint32_t timeout);
+
+/*
+ * copie jusqu'a n elements ; retourne le nombre d'elements copies
+ */
+uint32_t anneau_ecrit(ANNEAU *r, const void *elems, uint32_t n);
+uint32_t anneau_lit(ANNEAU *r, void *elems, uint32_t n);
+
+/*
+ * acces direct par zones contigues, sans copie
+ * anneau_zone_ecriture donne l'adresse et le nombre d'elements libres
+ * contigus ; le producteur les remplit puis en publie tout ou partie par
+ * anneau_publie. Meme principe cote consommateur avec anneau_zone_lecture
+ * et anneau_libere.
+ */
+uint32_t anneau_zone_ecriture(ANNEAU *r, void **zone);
+void anneau_publie(ANNEAU *r, uint32_t n);
+uint32_t anneau_zone_lecture(ANNEAU *r, const void **zone);
+void anneau_libere(ANNEAU *r, uint32_t n);
+
+/*
+ * nombre d'elements presents ; exact pour le consommateur, minorant pour
+ * le producteur
+ */
+uint32_t anneau_nb(ANNEAU *r);
+
+#endif
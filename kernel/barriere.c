@@ -0,0 +1,115 @@
+/*----------------------------------------------------------------------------*
+ * fichier : barriere.c                                                       *
+ * barrieres et loquets de synchronisation pour le mini-noyau temps reel      *
+ *----------------------------------------------------------------------------*/
+
+#include "barriere.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * reveille toutes les taches de la file, sans commutation
+ * sortie : nombre de taches reveillees
+ */
+static uint32_t reveille_tout(FILE_ATTENTE *f) {
+	uint32_t reveils = 0;
+
+	while (attente_reveille(f, ATT_OK) != MAX_TACHES_NOYAU) {
+		reveils++;
+	}
+	return reveils;
+}
+
+/*
+ * decompte, en section critique
+ * sortie : nombre de taches reveillees
+ */
+static uint32_t loquet_libere(LOQUET *l) {
+	if (l->compte == 0 || --l->compte != 0) {
+		return 0;
+	}
+	return reveille_tout(&l->file);
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void barriere_init(BARRIERE *b, uint8_t parties) {
+	file_att_init(&b->file);
+	b->parties = parties;
+	b->phase = 0;
+}
+
+/*
+ * arrive a la barriere
+ * entre  : barriere, delai d'attente maximal en ticks, adresse ou ranger
+ *          le numero de phase (peut etre nulle)
+ * sortie : ATT_OK ou ATT_TIMEOUT
+ * description : les arrivees sont comptees par la file d'attente elle-meme :
+ *               une tache dont le delai expire en est retiree par le noyau
+ *               et ne compte plus. La derniere arrivee ne s'endort pas.
+ */
+uint8_t barriere_attend(BARRIERE *b, uint32_t timeout, uint32_t *phase) {
+	uint8_t etat = ATT_OK;
+
+	_lock_();
+	if (phase) {
+		*phase = b->phase;
+	}
+	if (b->file.nb + 1 >= b->parties) {
+		b->phase++;
+		if (reveille_tout(&b->file)) {
+			schedule();
+		}
+	} else if (timeout == 0) {
+		etat = ATT_TIMEOUT;
+	} else {
+		attente(&b->file, timeout);
+		_unlock_();
+		return attente_etat();
+	}
+	_unlock_();
+	return etat;
+}
+
+void loquet_init(LOQUET *l, uint32_t compte) {
+	file_att_init(&l->file);
+	l->compte = compte;
+}
+
+void loquet_decompte(LOQUET *l) {
+	_lock_();
+	if (loquet_libere(l)) {
+		schedule();
+	}
+	_unlock_();
+}
+
+void loquet_decompte_from_isr(LOQUET *l, uint8_t *reveil) {
+	_lock_();
+	if (loquet_libere(l)) {
+		*reveil = 1;
+	}
+	_unlock_();
+}
+
+uint8_t loquet_attend(LOQUET *l, uint32_t timeout) {
+	_lock_();
+	if (l->compte == 0) {
+		_unlock_();
+		return ATT_OK;
+	}
+	if (timeout == 0) {
+		_unlock_();
+		return ATT_TIMEOUT;
+	}
+	attente(&l->file, timeout);
+	_unlock_();
+	return attente_etat();
+}
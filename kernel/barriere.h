@@ -0,0 +1,70 @@
+/*----------------------------------------------------------------------------*
+ * fichier : barriere.h                                                       *
+ * barrieres et loquets de synchronisation pour le mini-noyau temps reel      *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __BARRIERE_H__
+#define __BARRIERE_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * barriere reutilisable : les taches attendent que parties d'entre elles
+ * soient arrivees, puis repartent ensemble pour la phase suivante
+ */
+typedef struct {
+    FILE_ATTENTE file;      // taches arrivees, en attente des autres
+    uint8_t parties;        // nombre de taches par phase
+    uint32_t phase;         // numero de la phase courante
+} BARRIERE;
+
+/*
+ * loquet a usage unique : les taches attendent que le compte a rebours
+ * atteigne 0, il reste ensuite ouvert
+ */
+typedef struct {
+    FILE_ATTENTE file;      // taches en attente de l'ouverture
+    uint32_t compte;        // decomptes restants
+} LOQUET;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+void barriere_init(BARRIERE *b, uint8_t parties);
+
+/*
+ * arrive a la barriere et attend les autres taches de la phase, au plus
+ * timeout ticks (0 : pas d'attente, ATT_INFINI : pas de limite)
+ * retourne ATT_OK quand la phase est complete, ATT_TIMEOUT si le delai a
+ * expire (la tache ne compte plus parmi les arrivees) ; si phase n'est pas
+ * nul, il recoit le numero de la phase franchie
+ * la derniere arrivee reveille toutes les autres dans une seule section
+ * critique, avec une seule demande de commutation
+ */
+uint8_t barriere_attend(BARRIERE *b, uint32_t timeout, uint32_t *phase);
+
+void loquet_init(LOQUET *l, uint32_t compte);
+
+/*
+ * decompte ; le dernier decompte reveille toutes les taches en attente en
+ * une seule passe. loquet_decompte_from_isr ne commute pas et met *reveil
+ * a 1 si des taches ont ete reveillees (voir s_signal_from_isr)
+ */
+void loquet_decompte(LOQUET *l);
+void loquet_decompte_from_isr(LOQUET *l, uint8_t *reveil);
+
+/*
+ * attend l'ouverture du loquet, au plus timeout ticks ; retourne
+ * immediatement ATT_OK s'il est deja ouvert, ATT_TIMEOUT si le delai a
+ * expire
+ */
+uint8_t loquet_attend(LOQUET *l, uint32_t timeout);
+
+#endif
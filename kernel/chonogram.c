@@ -8,11 +8,27 @@
 #include "chronogram.h"
 
 #include "../io/TERMINAL.h"
+#include "../io/link.h"
 #include "noyau_file_prio.h"
+#include "noyau_prio.h"
 
 static int posx = 1;
 static int print_hdr = 1;
 
+#ifdef CONSOLE_LINK
+/* Sur la liaison multiplexée, le chronogramme part en trace binaire :
+ * numéro de tâche, séparateur, date en ticks (poids faible en premier).
+ * Le dessin est laissé à l'hôte.
+ */
+void draw_tick(uint16_t task_id, char sep)
+{
+	uint32_t ticks = noyau_get_ticks();
+	uint8_t trace[6] = {task_id, sep, ticks, ticks >> 8, ticks >> 16,
+			ticks >> 24};
+
+	link_send(LINK_TRACE, trace, sizeof(trace));
+}
+#else
 void draw_tick(uint16_t task_id, char sep)
 {
 	uint8_t prio = task_id >> 3;
@@ -42,3 +58,4 @@ void draw_tick(uint16_t task_id, char sep)
 	}
 	posx = posx + 3;
 }
+#endif
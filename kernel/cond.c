@@ -0,0 +1,130 @@
+/*----------------------------------------------------------------------------*
+ * fichier : cond.c                                                           *
+ * variables de condition pour le mini-noyau temps reel                       *
+ *----------------------------------------------------------------------------*/
+
+#include "cond.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * transfere sur le mutex la tache en attente la plus prioritaire
+ * sortie : 0 si la file est vide, 1 sinon
+ * appelee en section critique, sans commutation
+ */
+static uint8_t cv_transfere(COND *cv) {
+	uint16_t t = file_att_premier(&cv->file);
+
+	if (t == MAX_TACHES_NOYAU) {
+		return 0;
+	}
+	m_transfere(cv->mutex, &cv->file, t);
+	if (file_att_premier(&cv->file) == MAX_TACHES_NOYAU) {
+		cv->mutex = NULL;
+	}
+	return 1;
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void cv_init(COND *cv) {
+	file_att_init(&cv->file);
+	cv->mutex = NULL;
+}
+
+/*
+ * detruit une variable de condition
+ * description : les taches en attente sont reveillees avec ATT_DETRUIT ;
+ *               chacune reprend le mutex avant de retourner
+ */
+void cv_detruit(COND *cv) {
+	_lock_();
+	while (attente_reveille(&cv->file, ATT_DETRUIT) != MAX_TACHES_NOYAU)
+		continue;
+	cv->mutex = NULL;
+	schedule();
+	_unlock_();
+}
+
+/*
+ * attend la condition
+ * entre  : variable de condition, mutex detenu par la tache courante,
+ *          delai d'attente maximal en ticks (0 : pas d'attente,
+ *          ATT_INFINI : pas de limite)
+ * sortie : ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT ; le mutex est detenu
+ * description : le mutex est libere et la tache mise en attente dans la
+ *               meme section critique. Apres cv_signal, la tache attend
+ *               le mutex dans sa file sans limite de temps et le recoit
+ *               directement a la liberation. Apres expiration ou
+ *               destruction, elle le reprend par m_acquire_p.
+ */
+uint8_t cv_wait(COND *cv, MUTEX *m, uint32_t timeout) {
+	uint8_t imbrique, etat;
+
+	if (timeout == 0) {
+		return ATT_TIMEOUT;
+	}
+
+	_lock_();
+	if (cv->mutex != NULL && cv->mutex != m) {
+		printf("Variable de condition attendue avec deux mutex differents\n");
+		noyau_exit();
+	}
+	cv->mutex = m;
+	imbrique = m_libere_tout(m);
+	attente(&cv->file, timeout);
+	_unlock_();
+
+	etat = attente_etat();
+	if (etat != ATT_OK) {
+		// hors de la file : il faut reprendre le mutex
+		_lock_();
+		if (file_att_premier(&cv->file) == MAX_TACHES_NOYAU) {
+			cv->mutex = NULL;
+		}
+		_unlock_();
+		m_acquire_timeout_p(m, ATT_INFINI);
+	}
+	m_reprend(m, imbrique);
+	return etat;
+}
+
+/*
+ * reveille la tache en attente la plus prioritaire
+ * description : elle passe dans la file du mutex (ou le recoit s'il est
+ *               libre) ; sans effet si personne n'attend
+ */
+void cv_signal(COND *cv) {
+	_lock_();
+	if (cv_transfere(cv)) {
+		schedule();
+	}
+	_unlock_();
+}
+
+/*
+ * reveille toutes les taches en attente
+ * description : toutes passent dans la file du mutex en une seule section
+ *               critique et une seule demande de commutation ; elles
+ *               l'obtiendront une a une, par priorite
+ */
+void cv_broadcast(COND *cv) {
+	uint8_t reveil = 0;
+
+	_lock_();
+	while (cv_transfere(cv)) {
+		reveil = 1;
+	}
+	if (reveil) {
+		schedule();
+	}
+	_unlock_();
+}
@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------*
+ * fichier : cond.h                                                           *
+ * variables de condition pour le mini-noyau temps reel                       *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __COND_H__
+#define __COND_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+#include "mutex.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant une variable de condition, allouee par
+ * l'application ; toutes les taches qui attendent en meme temps utilisent
+ * le meme mutex
+ */
+typedef struct {
+    FILE_ATTENTE file;      // taches en attente, par priorite
+    MUTEX *mutex;           // mutex associe, NULL si personne n'attend
+} COND;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise et detruit une variable de condition ; les taches en attente
+ * lors de la destruction reprennent le mutex et terminent par ATT_DETRUIT
+ */
+void cv_init(COND *cv);
+void cv_detruit(COND *cv);
+
+/*
+ * libere le mutex m (detenu par la tache courante, a n'importe quel niveau
+ * de re-acquisition) et attend la condition, en une seule section
+ * critique : un signal emis apres la liberation n'est pas perdu
+ * au retour, la tache detient de nouveau m au meme niveau, quel que soit
+ * le resultat : ATT_OK (signal), ATT_TIMEOUT apres timeout ticks,
+ * ATT_DETRUIT. Le predicat doit etre reteste :
+ *     m_acquire_p(&m);
+ *     while (!pret)
+ *         cv_wait(&cv, &m, ATT_INFINI);
+ *     ...
+ *     m_release_p(&m);
+ * un mutex de la table est designe par m_adresse(n)
+ */
+uint8_t cv_wait(COND *cv, MUTEX *m, uint32_t timeout);
+
+/*
+ * reveille la tache en attente la plus prioritaire (cv_signal) ou toutes
+ * (cv_broadcast). Les taches ne sont pas rendues eligibles : elles passent
+ * directement dans la file d'attente du mutex, et seule celle qui l'obtient
+ * s'execute. Les appeler en detenant le mutex evite les reveils inutiles.
+ */
+void cv_signal(COND *cv);
+void cv_broadcast(COND *cv);
+
+#endif
@@ -60,6 +60,19 @@ void delay_process(void){
 			if (p_tcb[i].delay != 0){
 				p_tcb[i].delay--;
 				if (p_tcb[i].delay == 0){
+					/* attente bornee sur un objet : retrait de sa file */
+					if (p_tcb[i].file_att != NULL){
+						FILE_ATTENTE *f = p_tcb[i].file_att;
+
+						_lock_();
+						file_att_retire(f, i);
+						p_tcb[i].file_att = NULL;
+						p_tcb[i].att_etat = ATT_TIMEOUT;
+						if (f->expire != NULL){
+							f->expire(f, i);
+						}
+						_unlock_();
+					}
 					p_tcb[i].status = EXEC;
 					file_ajoute(i);
 				}
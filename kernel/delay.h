@@ -26,6 +26,8 @@ void delay(uint32_t nticks);
  * 				 pour celles dont le compteur est non nul
  * 				 	décrémente le compteur
  * 				 	remet la tache en exécution si son compteur arrive à zéro
+ * 				 	(si elle attendait un objet, elle est retirée de sa file
+ * 				 	 et son attente se termine par ATT_TIMEOUT)
  *
  */
 void delay_process(void);
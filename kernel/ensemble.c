@@ -0,0 +1,144 @@
+/*----------------------------------------------------------------------------*
+ * fichier : ensemble.c                                                       *
+ * attente simultanee sur plusieurs objets du noyau                           *
+ *----------------------------------------------------------------------------*/
+
+#include "ensemble.h"
+
+#include "event.h"
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * reserve le membre suivant, arrete le noyau si l'ensemble est plein
+ */
+static ENS_MEMBRE *ens_nouveau(ENSEMBLE *e) {
+	if (e->nb == ENS_MAX_MEMBRES) {
+		printf("Ensemble plein\n");
+		noyau_exit();
+	}
+	return &e->membres[e->nb];
+}
+
+/*
+ * teste si un membre est pret ; en section critique
+ */
+static int ens_pret(ENS_MEMBRE *m) {
+	switch (m->type) {
+	case ENS_SEM:
+		return ((SEMAPHORE *) m->objet)->valeur > 0;
+	case ENS_QUEUE:
+		return ((QUEUE *) m->objet)->nb > 0;
+	default:
+		return (ev_get(m->event) & m->masque) != 0;
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void ens_init(ENSEMBLE *e) {
+	file_att_init(&e->file);
+	e->nb = 0;
+}
+
+uint8_t ens_ajoute_sem(ENSEMBLE *e, SEMAPHORE *s) {
+	ENS_MEMBRE *m;
+	uint8_t i;
+
+	_lock_();
+	m = ens_nouveau(e);
+	i = e->nb;
+	m->type = ENS_SEM;
+	m->objet = s;
+	e->nb++;
+	s->ensemble = e;
+	_unlock_();
+	return i;
+}
+
+uint8_t ens_ajoute_queue(ENSEMBLE *e, QUEUE *q) {
+	ENS_MEMBRE *m;
+	uint8_t i;
+
+	_lock_();
+	m = ens_nouveau(e);
+	i = e->nb;
+	m->type = ENS_QUEUE;
+	m->objet = q;
+	e->nb++;
+	q->ensemble = e;
+	_unlock_();
+	return i;
+}
+
+uint8_t ens_ajoute_event(ENSEMBLE *e, uint8_t n, uint32_t masque) {
+	ENS_MEMBRE *m;
+	uint8_t i;
+
+	_lock_();
+	m = ens_nouveau(e);
+	i = e->nb;
+	m->type = ENS_EVENT;
+	m->event = n;
+	m->masque = masque;
+	e->nb++;
+	ev_ensemble(n, e);
+	_unlock_();
+	return i;
+}
+
+/*
+ * attend qu'un membre soit pret
+ * entre  : ensemble, delai d'attente maximal en ticks
+ * sortie : numero du premier membre pret, ENS_AUCUN si le delai a expire
+ * description : les membres sont testes a l'appel puis a chaque reveil
+ *               par l'un d'eux ; la tache ne s'execute pas entre deux
+ */
+uint8_t ens_attend(ENSEMBLE *e, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	int32_t reste;
+	uint8_t i;
+
+	_lock_();
+	for (;;) {
+		for (i = 0; i < e->nb; i++) {
+			if (ens_pret(&e->membres[i])) {
+				_unlock_();
+				return i;
+			}
+		}
+		if (timeout != ATT_INFINI) {
+			reste = (int32_t) (echeance - noyau_get_ticks());
+			if (reste <= 0) {
+				break;
+			}
+		}
+		attente(&e->file, (timeout == ATT_INFINI) ? ATT_INFINI : (uint32_t) reste);
+		_unlock_();		/* commutation, reprise au reveil */
+		_lock_();
+		if (attente_etat() != ATT_OK) {
+			break;
+		}
+	}
+	_unlock_();
+	return ENS_AUCUN;
+}
+
+/*
+ * reveille toutes les taches en attente sur l'ensemble
+ */
+uint32_t ens_signale(struct ENSEMBLE *e) {
+	uint32_t reveils = 0;
+
+	while (attente_reveille(&e->file, ATT_OK) != MAX_TACHES_NOYAU) {
+		reveils++;
+	}
+	return reveils;
+}
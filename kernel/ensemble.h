@@ -0,0 +1,84 @@
+/*----------------------------------------------------------------------------*
+ * fichier : ensemble.h                                                       *
+ * attente simultanee sur plusieurs objets du noyau                           *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __ENSEMBLE_H__
+#define __ENSEMBLE_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+#include "sem.h"
+#include "queue.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+#define ENS_MAX_MEMBRES 16
+#define ENS_AUCUN       0xff    // retour de ens_attend : aucun membre pret
+
+/*
+ * types de membres
+ */
+#define ENS_SEM        0   // semaphore : un jeton est disponible
+#define ENS_QUEUE      1   // file de messages : un element est present
+#define ENS_EVENT      2   // groupe de drapeaux : un drapeau du masque est leve
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t type;           // ENS_SEM, ENS_QUEUE ou ENS_EVENT
+    uint8_t event;          // numero du groupe (ENS_EVENT)
+    uint32_t masque;        // drapeaux attendus (ENS_EVENT)
+    void *objet;            // SEMAPHORE ou QUEUE
+} ENS_MEMBRE;
+
+/*
+ * structure definissant un ensemble d'objets, allouee par l'application
+ */
+typedef struct ENSEMBLE {
+    FILE_ATTENTE file;      // taches en attente d'un membre pret
+    uint8_t nb;             // nombre de membres
+    ENS_MEMBRE membres[ENS_MAX_MEMBRES];
+} ENSEMBLE;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * un objet appartient a un seul ensemble, jusqu'a sa fermeture ; les
+ * fonctions d'ajout retournent le numero du membre (ordre d'ajout), et
+ * arretent le noyau si l'ensemble est plein
+ */
+void ens_init(ENSEMBLE *e);
+uint8_t ens_ajoute_sem(ENSEMBLE *e, SEMAPHORE *s);
+uint8_t ens_ajoute_queue(ENSEMBLE *e, QUEUE *q);
+uint8_t ens_ajoute_event(ENSEMBLE *e, uint8_t n, uint32_t masque);
+
+/*
+ * attend qu'un membre soit pret, au plus timeout ticks (0 : pas
+ * d'attente, ATT_INFINI : pas de limite)
+ * retourne le numero du premier membre pret dans l'ordre d'ajout, ENS_AUCUN
+ * si le delai a expire. Rien n'est preleve : la tache prend ensuite
+ * l'element sans attendre (s_wait_timeout_p(s, 0), q_try_receive, ev_clear) ;
+ * c'est garanti si elle est seule a consommer ces objets
+ *     switch (ens_attend(&passerelle, ATT_INFINI)) {
+ *     case RX:  q_try_receive(&rx, &trame); ...
+ *     case CMD: s_wait_timeout_p(&cmd, 0); ...
+ *     }
+ */
+uint8_t ens_attend(ENSEMBLE *e, uint32_t timeout);
+
+/*
+ * usage interne (sem.c, queue.c, event.c), en section critique : un
+ * membre est devenu pret, les taches en attente sont rendues eligibles
+ * sortie : nombre de taches reveillees, l'appelant appelle schedule()
+ */
+uint32_t ens_signale(struct ENSEMBLE *e);
+
+#endif
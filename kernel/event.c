@@ -0,0 +1,233 @@
+/*----------------------------------------------------------------------------*
+ * fichier : event.c                                                          *
+ * groupes de drapeaux d'evenements pour le mini-noyau temps reel             *
+ *----------------------------------------------------------------------------*/
+
+#include "event.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "ensemble.h"
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant un groupe de drapeaux
+ */
+typedef struct {
+    FILE_ATTENTE file;      // taches en attente, par priorite
+    uint32_t drapeaux;      // valeur courante des drapeaux
+    struct ENSEMBLE *ensemble;  // ensemble d'attente, NULL sinon
+    uint8_t cree;           // 0 si le groupe est libre
+} EVENT;
+
+/*----------------------------------------------------------------------------*
+ * variables globales internes                                                *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * variable stockant tous les groupes du systeme
+ */
+static EVENT _event[MAX_EVENT];
+
+/*
+ * condition attendue par chaque tache, et drapeaux qui l'ont satisfaite
+ */
+static uint32_t _ev_masque[MAX_TACHES_NOYAU];
+static uint8_t _ev_options[MAX_TACHES_NOYAU];
+static uint32_t _ev_obtenus[MAX_TACHES_NOYAU];
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * teste si les drapeaux satisfont la condition
+ */
+static int ev_satisfait(uint32_t drapeaux, uint32_t masque, uint8_t options) {
+	if (options & EV_ET) {
+		return (drapeaux & masque) == masque;
+	}
+	return (drapeaux & masque) != 0;
+}
+
+/*
+ * verifie qu'un groupe existe, arrete le noyau sinon
+ */
+static EVENT *ev_verifie(uint8_t n) {
+	if (n >= MAX_EVENT || !_event[n].cree) {
+		printf("Le groupe d'evenements %d n'a pas ete cree\n", n);
+		noyau_exit();
+	}
+	return &_event[n];
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise les groupes du systeme
+ * entre  : sans
+ * sortie : sans
+ */
+void ev_init(void) {
+	register unsigned j;
+
+	for (j = 0; j < MAX_EVENT; j++) {
+		_event[j].cree = 0;
+	}
+}
+
+/*
+ * cree un groupe de drapeaux
+ * entre  : valeur initiale des drapeaux
+ * sortie : numero du groupe cree
+ * description : en cas d'erreur, le noyau est arrete
+ */
+uint8_t ev_cree(uint32_t initial) {
+	register EVENT *e = _event;
+	register unsigned n = 0;
+
+	_lock_();
+	while (n < MAX_EVENT && e->cree) {
+		n++;
+		e++;
+	}
+	if (n == MAX_EVENT) {
+		printf("Plus de groupe d'evenements libre\n");
+		noyau_exit();
+	}
+	file_att_init(&e->file);
+	e->drapeaux = initial;
+	e->ensemble = NULL;
+	e->cree = 1;
+	_unlock_();
+
+	return n;
+}
+
+/*
+ * ferme un groupe ; les taches en attente sont reveillees avec ATT_DETRUIT
+ */
+void ev_close(uint8_t n) {
+	register EVENT *e;
+
+	_lock_();
+	e = ev_verifie(n);
+	while (attente_reveille(&e->file, ATT_DETRUIT) != MAX_TACHES_NOYAU)
+		continue;
+	e->cree = 0;
+	schedule();
+	_unlock_();
+}
+
+/*
+ * leve des drapeaux
+ * entre  : numero du groupe, drapeaux a lever
+ * sortie : valeur des drapeaux apres l'operation
+ * description : parcourt une seule fois la file d'attente et reveille toutes
+ *               les taches satisfaites. Les drapeaux a effacer (EV_EFFACE)
+ *               ne sont baisses qu'apres le parcours : toutes les taches
+ *               satisfaites par le meme ev_set voient les memes drapeaux.
+ */
+uint32_t ev_set(uint8_t n, uint32_t masque) {
+	register EVENT *e;
+	uint32_t efface = 0, valeur;
+	uint8_t t, suivant;
+	int reveil = 0;
+
+	_lock_();
+	e = ev_verifie(n);
+	e->drapeaux |= masque;
+	for (t = e->file.tete; t != ATT_FIN; t = suivant) {
+		suivant = noyau_get_p_tcb(t)->suivant_att;
+		if (ev_satisfait(e->drapeaux, _ev_masque[t], _ev_options[t])) {
+			_ev_obtenus[t] = e->drapeaux;
+			if (_ev_options[t] & EV_EFFACE) {
+				efface |= _ev_masque[t];
+			}
+			attente_termine(&e->file, t, ATT_OK);
+			reveil = 1;
+		}
+	}
+	e->drapeaux &= ~efface;
+	valeur = e->drapeaux;
+	if (valeur && e->ensemble != NULL && ens_signale(e->ensemble)) {
+		reveil = 1;
+	}
+	if (reveil) {
+		schedule();
+	}
+	_unlock_();
+
+	return valeur;
+}
+
+/*
+ * baisse des drapeaux
+ * entre  : numero du groupe, drapeaux a baisser
+ * sortie : valeur des drapeaux apres l'operation
+ */
+uint32_t ev_clear(uint8_t n, uint32_t masque) {
+	uint32_t valeur;
+
+	_lock_();
+	valeur = (ev_verifie(n)->drapeaux &= ~masque);
+	_unlock_();
+
+	return valeur;
+}
+
+uint32_t ev_get(uint8_t n) {
+	return ev_verifie(n)->drapeaux;
+}
+
+void ev_ensemble(uint8_t n, struct ENSEMBLE *ens) {
+	ev_verifie(n)->ensemble = ens;
+}
+
+/*
+ * attend une combinaison de drapeaux
+ * entre  : numero du groupe, drapeaux attendus, options (EV_OU ou EV_ET,
+ *          EV_EFFACE), delai d'attente maximal en ticks, adresse ou ranger
+ *          les drapeaux obtenus (peut etre nulle)
+ * sortie : ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT
+ */
+uint8_t ev_wait(uint8_t n, uint32_t masque, uint8_t options,
+		uint32_t timeout, uint32_t *obtenus) {
+	register EVENT *e;
+	uint16_t tc = noyau_get_tc();
+	uint32_t valeur;
+	uint8_t etat;
+
+	_lock_();
+	e = ev_verifie(n);
+	valeur = e->drapeaux;
+	if (ev_satisfait(valeur, masque, options)) {
+		if (options & EV_EFFACE) {
+			e->drapeaux &= ~masque;
+		}
+		etat = ATT_OK;
+	} else if (timeout == 0) {
+		etat = ATT_TIMEOUT;
+	} else {
+		/* ev_set teste la condition et range les drapeaux obtenus */
+		_ev_masque[tc] = masque;
+		_ev_options[tc] = options;
+		attente(&e->file, timeout);
+		_unlock_();
+		_lock_();
+		etat = attente_etat();
+		valeur = (etat == ATT_OK) ? _ev_obtenus[tc] : e->drapeaux;
+	}
+	_unlock_();
+
+	if (obtenus) {
+		*obtenus = valeur;
+	}
+	return etat;
+}
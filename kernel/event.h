@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------*
+ * fichier : event.h                                                          *
+ * groupes de drapeaux d'evenements pour le mini-noyau temps reel             *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+#define MAX_EVENT      16
+
+/*
+ * options de ev_wait, a combiner par |
+ */
+#define EV_OU          0x00    // au moins un drapeau du masque est leve
+#define EV_ET          0x01    // tous les drapeaux du masque sont leves
+#define EV_EFFACE      0x02    // les drapeaux du masque sont baisses en sortie
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * un groupe contient 32 drapeaux. Contrairement a reveille(), un drapeau
+ * leve reste memorise jusqu'a ce qu'il soit baisse : un evenement signale
+ * avant l'attente n'est pas perdu.
+ */
+void ev_init(void);
+uint8_t ev_cree(uint32_t initial);
+void ev_close(uint8_t n);
+
+/*
+ * leve ou baisse des drapeaux ; ev_set reveille en une seule passe toutes
+ * les taches dont la condition est satisfaite. Les deux fonctions peuvent
+ * etre appelees en interruption. Elles retournent la valeur des drapeaux
+ * apres l'operation.
+ */
+uint32_t ev_set(uint8_t n, uint32_t masque);
+uint32_t ev_clear(uint8_t n, uint32_t masque);
+uint32_t ev_get(uint8_t n);
+
+/*
+ * attend les drapeaux du masque selon les options (EV_OU ou EV_ET, plus
+ * EV_EFFACE), au plus timeout ticks (0 : pas d'attente, ATT_INFINI : pas
+ * de limite)
+ * retourne ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT ; si obtenus n'est pas nul,
+ * il recoit la valeur des drapeaux qui a satisfait la condition (avant
+ * effacement), ou leur valeur courante en cas d'echec
+ */
+uint8_t ev_wait(uint8_t n, uint32_t masque, uint8_t options,
+		uint32_t timeout, uint32_t *obtenus);
+
+/*
+ * usage interne (ensemble.c) : rattache le groupe a un ensemble d'attente
+ */
+struct ENSEMBLE;
+void ev_ensemble(uint8_t n, struct ENSEMBLE *ens);
+
+#endif
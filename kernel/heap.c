@@ -0,0 +1,347 @@
+/*----------------------------------------------------------------------------*
+ * fichier : heap.c                                                           *
+ * tas a temps d'execution borne (TLSF) pour le mini-noyau temps reel         *
+ *----------------------------------------------------------------------------*/
+
+#include "heap.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+
+/*
+ * zone du tas, definie dans ld.x
+ */
+extern uint8_t __heap[];
+extern uint8_t __eheap[];
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * classes de tailles : le premier niveau est la puissance de 2, le second
+ * la divise en HEAP_SL_NB intervalles egaux. Les blocs de moins de
+ * HEAP_PETIT octets sont ranges au premier niveau 0, par pas de 4 octets.
+ */
+#define HEAP_ALIGN      4
+#define HEAP_SL_LOG2    4
+#define HEAP_SL_NB      (1 << HEAP_SL_LOG2)
+#define HEAP_FL_DECALE  (HEAP_SL_LOG2 + 2)
+#define HEAP_PETIT      (1 << HEAP_FL_DECALE)
+#define HEAP_FL_MAX     24
+#define HEAP_FL_NB      (HEAP_FL_MAX - HEAP_FL_DECALE + 1)
+
+/*
+ * mot taille d'un bloc : bits 2..23 taille utile, bit 0 bloc libre, bit 1
+ * bloc precedent libre, bits 24..31 tache proprietaire
+ */
+#define BLOC_LIBRE          0x1
+#define BLOC_PREC_LIBRE     0x2
+#define BLOC_TAILLE         0x00fffffc
+#define BLOC_TACHE_DECALE   24
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * en-tete d'un bloc
+ * prec_phys occupe le dernier mot du bloc precedent et n'est valide que si
+ * celui-ci est libre ; suiv_libre et prec_libre occupent le debut de la
+ * zone utile et ne sont valides que si le bloc est libre. Le surcout d'un
+ * bloc alloue est donc le seul mot taille.
+ */
+typedef struct BLOC {
+    struct BLOC *prec_phys;
+    uint32_t taille;
+    struct BLOC *suiv_libre;
+    struct BLOC *prec_libre;
+} BLOC;
+
+#define BLOC_DEBUT      offsetof(BLOC, suiv_libre)
+#define BLOC_RECOUVRE   offsetof(BLOC, taille)
+#define BLOC_SURCOUT    (BLOC_DEBUT - BLOC_RECOUVRE)
+#define BLOC_MIN        (sizeof(BLOC) - BLOC_RECOUVRE)
+
+/*----------------------------------------------------------------------------*
+ * variables globales internes                                                *
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _fl_bitmap;
+static uint32_t _sl_bitmap[HEAP_FL_NB];
+static BLOC *_libres[HEAP_FL_NB][HEAP_SL_NB];
+
+static uint32_t _total;
+static uint32_t _utilise;
+static uint32_t _pic;
+
+#ifdef HEAP_PAR_TACHE
+static uint32_t _par_tache[MAX_TACHES_NOYAU];
+#endif
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/* rang du bit de poids fort, du bit de poids faible (instructions CLZ) */
+static inline int heap_fls(uint32_t x) {
+	return 31 - __builtin_clz(x);
+}
+
+static inline int heap_ffs(uint32_t x) {
+	return __builtin_ctz(x);
+}
+
+static inline uint32_t bloc_taille(BLOC *b) {
+	return b->taille & BLOC_TAILLE;
+}
+
+static inline void *bloc_ptr(BLOC *b) {
+	return (uint8_t *) b + BLOC_DEBUT;
+}
+
+static inline BLOC *bloc_de_ptr(void *p) {
+	return (BLOC *) ((uint8_t *) p - BLOC_DEBUT);
+}
+
+/* bloc physiquement suivant, dont le champ prec_phys recoit b */
+static inline BLOC *bloc_lie_suivant(BLOC *b) {
+	BLOC *s = (BLOC *) ((uint8_t *) bloc_ptr(b) + bloc_taille(b) - BLOC_RECOUVRE);
+
+	s->prec_phys = b;
+	return s;
+}
+
+static void bloc_marque_libre(BLOC *b) {
+	b->taille |= BLOC_LIBRE;
+	bloc_lie_suivant(b)->taille |= BLOC_PREC_LIBRE;
+}
+
+static void bloc_marque_utilise(BLOC *b) {
+	b->taille &= ~BLOC_LIBRE;
+	bloc_lie_suivant(b)->taille &= ~BLOC_PREC_LIBRE;
+}
+
+/* classe (fl, sl) d'un bloc de la taille donnee */
+static void heap_classe(uint32_t taille, int *fl, int *sl) {
+	if (taille < HEAP_PETIT) {
+		*fl = 0;
+		*sl = taille / (HEAP_PETIT / HEAP_SL_NB);
+	} else {
+		int f = heap_fls(taille);
+		*sl = (taille >> (f - HEAP_SL_LOG2)) ^ HEAP_SL_NB;
+		*fl = f - (HEAP_FL_DECALE - 1);
+	}
+}
+
+/* classe de recherche : la plus petite dont tous les blocs conviennent */
+static void heap_classe_recherche(uint32_t taille, int *fl, int *sl) {
+	if (taille >= HEAP_PETIT) {
+		taille += (1 << (heap_fls(taille) - HEAP_SL_LOG2)) - 1;
+	}
+	heap_classe(taille, fl, sl);
+}
+
+static void heap_insere(BLOC *b) {
+	int fl, sl;
+
+	heap_classe(bloc_taille(b), &fl, &sl);
+	b->prec_libre = 0;
+	b->suiv_libre = _libres[fl][sl];
+	if (b->suiv_libre) {
+		b->suiv_libre->prec_libre = b;
+	}
+	_libres[fl][sl] = b;
+	_fl_bitmap |= 1u << fl;
+	_sl_bitmap[fl] |= 1u << sl;
+}
+
+static void heap_retire(BLOC *b) {
+	int fl, sl;
+
+	heap_classe(bloc_taille(b), &fl, &sl);
+	if (b->prec_libre) {
+		b->prec_libre->suiv_libre = b->suiv_libre;
+	} else {
+		_libres[fl][sl] = b->suiv_libre;
+		if (!b->suiv_libre) {
+			_sl_bitmap[fl] &= ~(1u << sl);
+			if (!_sl_bitmap[fl]) {
+				_fl_bitmap &= ~(1u << fl);
+			}
+		}
+	}
+	if (b->suiv_libre) {
+		b->suiv_libre->prec_libre = b->prec_libre;
+	}
+}
+
+/* premier bloc libre d'une classe superieure ou egale a (fl, sl) */
+static BLOC *heap_cherche(int fl, int sl) {
+	uint32_t sl_map, fl_map;
+
+	if (fl >= HEAP_FL_NB) {
+		return 0;
+	}
+	sl_map = _sl_bitmap[fl] & (~0u << sl);
+	if (!sl_map) {
+		fl_map = _fl_bitmap & (fl + 1 < 32 ? ~0u << (fl + 1) : 0);
+		if (!fl_map) {
+			return 0;
+		}
+		fl = heap_ffs(fl_map);
+		sl_map = _sl_bitmap[fl];
+	}
+	return _libres[fl][heap_ffs(sl_map)];
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void heap_init(void) {
+	uint8_t *debut = (uint8_t *) (((uint32_t) __heap + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1));
+	uint32_t taille = ((uint32_t) (__eheap - debut) - BLOC_DEBUT - BLOC_SURCOUT)
+			& ~(HEAP_ALIGN - 1);
+	BLOC *b = (BLOC *) debut;
+	BLOC *sentinelle;
+	int fl;
+
+	_fl_bitmap = 0;
+	for (fl = 0; fl < HEAP_FL_NB; fl++) {
+		_sl_bitmap[fl] = 0;
+		for (int sl = 0; sl < HEAP_SL_NB; sl++) {
+			_libres[fl][sl] = 0;
+		}
+	}
+	if (taille > BLOC_TAILLE) {
+		taille = BLOC_TAILLE;
+	}
+
+	/* un seul bloc libre, suivi d'un bloc de taille nulle toujours utilise
+	 * qui arrete les fusions */
+	b->taille = taille;
+	sentinelle = bloc_lie_suivant(b);
+	sentinelle->taille = 0;
+	bloc_marque_libre(b);
+	heap_insere(b);
+
+	_total = taille;
+	_utilise = 0;
+	_pic = 0;
+}
+
+void *heap_alloc(size_t taille) {
+	BLOC *b, *reste;
+	uint32_t t;
+	int fl, sl;
+
+	if (taille == 0 || taille > BLOC_TAILLE) {
+		return 0;
+	}
+	t = (taille + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+	if (t < BLOC_MIN) {
+		t = BLOC_MIN;
+	}
+
+	_lock_();
+	heap_classe_recherche(t, &fl, &sl);
+	b = heap_cherche(fl, sl);
+	if (!b) {
+		_unlock_();
+		return 0;
+	}
+	heap_retire(b);
+
+	/* decoupe : le reste retourne aux listes libres */
+	if (bloc_taille(b) >= t + sizeof(BLOC)) {
+		reste = (BLOC *) ((uint8_t *) bloc_ptr(b) + t - BLOC_RECOUVRE);
+		reste->taille = bloc_taille(b) - t - BLOC_SURCOUT;
+		b->taille = t | (b->taille & ~BLOC_TAILLE);
+		bloc_lie_suivant(b);
+		bloc_marque_libre(reste);
+		heap_insere(reste);
+	}
+	bloc_marque_utilise(b);
+	b->taille = (b->taille & ~(0xffu << BLOC_TACHE_DECALE))
+			| ((uint32_t) noyau_get_tc() << BLOC_TACHE_DECALE);
+
+	_utilise += bloc_taille(b) + BLOC_SURCOUT;
+	if (_utilise > _pic) {
+		_pic = _utilise;
+	}
+#ifdef HEAP_PAR_TACHE
+	_par_tache[noyau_get_tc()] += bloc_taille(b) + BLOC_SURCOUT;
+#endif
+	_unlock_();
+
+	return bloc_ptr(b);
+}
+
+void heap_free(void *p) {
+	BLOC *b, *voisin;
+
+	if (!p) {
+		return;
+	}
+	b = bloc_de_ptr(p);
+
+	_lock_();
+	_utilise -= bloc_taille(b) + BLOC_SURCOUT;
+#ifdef HEAP_PAR_TACHE
+	_par_tache[b->taille >> BLOC_TACHE_DECALE] -= bloc_taille(b) + BLOC_SURCOUT;
+#endif
+	b->taille &= ~(0xffu << BLOC_TACHE_DECALE);
+	bloc_marque_libre(b);
+
+	/* fusion avec le bloc precedent, puis avec le suivant */
+	if (b->taille & BLOC_PREC_LIBRE) {
+		voisin = b->prec_phys;
+		heap_retire(voisin);
+		voisin->taille += bloc_taille(b) + BLOC_SURCOUT;
+		b = voisin;
+		bloc_lie_suivant(b);
+	}
+	voisin = bloc_lie_suivant(b);
+	if (voisin->taille & BLOC_LIBRE) {
+		heap_retire(voisin);
+		b->taille += bloc_taille(voisin) + BLOC_SURCOUT;
+		bloc_lie_suivant(b);
+	}
+	heap_insere(b);
+	_unlock_();
+}
+
+void heap_stats(HEAP_STATS *s) {
+	uint32_t libre, plus_grand = 0;
+	BLOC *b;
+	int fl;
+
+	_lock_();
+	s->total = _total;
+	s->utilise = _utilise;
+	s->pic = _pic;
+	/* les plus grands blocs sont dans la classe non vide la plus haute */
+	if (_fl_bitmap) {
+		fl = heap_fls(_fl_bitmap);
+		for (b = _libres[fl][heap_fls(_sl_bitmap[fl])]; b; b = b->suiv_libre) {
+			if (bloc_taille(b) > plus_grand) {
+				plus_grand = bloc_taille(b);
+			}
+		}
+	}
+	_unlock_();
+
+	libre = s->total - s->utilise;
+	s->plus_grand_libre = plus_grand;
+	s->fragmentation = libre ? 100 - (uint32_t) ((uint64_t) plus_grand * 100 / libre) : 0;
+}
+
+uint32_t heap_utilise_tache(uint16_t tache) {
+#ifdef HEAP_PAR_TACHE
+	return _par_tache[tache];
+#else
+	(void) tache;
+	return 0;
+#endif
+}
@@ -0,0 +1,54 @@
+/*----------------------------------------------------------------------------*
+ * fichier : heap.h                                                           *
+ * tas a temps d'execution borne (TLSF) pour le mini-noyau temps reel         *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * statistiques du tas, en octets
+ */
+typedef struct {
+    uint32_t total;             // taille utile du tas
+    uint32_t utilise;           // octets alloues, en-tetes compris
+    uint32_t pic;               // plus grande valeur atteinte par utilise
+    uint32_t plus_grand_libre;  // plus grande allocation possible
+    uint32_t fragmentation;     // 100 - plus_grand_libre * 100 / libre, en %
+} HEAP_STATS;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise le tas sur la zone __heap .. __eheap definie dans ld.x
+ */
+void heap_init(void);
+
+/*
+ * allocation et liberation en temps constant (deux niveaux de listes
+ * libres indexees par bitmaps, TLSF). heap_alloc retourne un bloc aligne
+ * sur 4 octets, 0 si aucun bloc libre ne convient. Les deux fonctions
+ * s'executent en section critique et peuvent etre appelees en
+ * interruption.
+ */
+void *heap_alloc(size_t taille);
+void heap_free(void *p);
+
+void heap_stats(HEAP_STATS *s);
+
+/*
+ * comptabilite par tache, si le noyau est compile avec HEAP_PAR_TACHE :
+ * octets alloues par la tache et non encore liberes (par elle ou une autre)
+ */
+uint32_t heap_utilise_tache(uint16_t tache);
+
+#endif
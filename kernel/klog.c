@@ -0,0 +1,137 @@
+/*----------------------------------------------------------------------------*
+ * fichier : klog.c                                                           *
+ * journal binaire differe pour le mini-noyau temps reel                      *
+ *----------------------------------------------------------------------------*/
+
+#include "klog.h"
+
+#include "../hwsupport/stm32h7xx.h"
+#include "../io/serialio.h"
+#include "noyau_prio.h"
+#include "delay.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant une entree du journal
+ * fmt vaut 0 tant que l'entree n'est pas completement ecrite
+ */
+typedef struct {
+    const char * volatile fmt;   // adresse de la chaine de format
+    uint32_t ticks;              // date en ticks noyau
+    uint32_t cycles;             // valeur du systick a la date de l'appel
+    uint32_t args[KLOG_MAX_ARGS];// arguments bruts
+} KLOG_ENTREE;
+
+/*----------------------------------------------------------------------------*
+ * variables globales internes                                                *
+ *----------------------------------------------------------------------------*/
+
+static KLOG_ENTREE _klog[KLOG_TAILLE];
+
+/*
+ * index de la prochaine entree a reserver (producteurs)
+ * et de la prochaine entree a lire (consommateur unique)
+ * les index croissent sans fin, la case est index & (KLOG_TAILLE - 1)
+ */
+static volatile uint32_t _klog_tete;
+static volatile uint32_t _klog_queue;
+static volatile uint32_t _klog_perdus;
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * enregistre une entree dans le journal
+ * entre  : format et arguments bruts
+ * sortie : sans
+ * description : reserve une case par LDREX/STREX sur l'index de tete, sans
+ *               masquer les interruptions, puis la remplit et la publie en
+ *               ecrivant le format en dernier. Si le journal est plein,
+ *               l'entree est perdue et comptee.
+ */
+void klog_write(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3) {
+	register KLOG_ENTREE *e;
+	register uint32_t n;
+
+	do {
+		n = _ldrex(&_klog_tete);
+		if (n - _klog_queue >= KLOG_TAILLE) {
+			_clrex();
+			do {
+				n = _ldrex(&_klog_perdus);
+			} while (_strex(&_klog_perdus, n + 1));
+			return;
+		}
+	} while (_strex(&_klog_tete, n + 1));
+
+	e = &_klog[n & (KLOG_TAILLE - 1)];
+	e->ticks = noyau_get_ticks();
+	e->cycles = systick_get();
+	e->args[0] = a0;
+	e->args[1] = a1;
+	e->args[2] = a2;
+	e->args[3] = a3;
+	_DMB();
+	e->fmt = fmt;
+}
+
+/*
+ * vide les entrees publiees, dans l'ordre de reservation
+ * entre  : 0 pour formater les messages, 1 pour une sortie brute
+ * sortie : nombre d'entrees traitees
+ * description : s'arrete sur la premiere entree reservee mais pas encore
+ *               publiee (ecrivain interrompu) ; elle sera traitee au
+ *               prochain appel
+ */
+static int klog_vide(int brut) {
+	register KLOG_ENTREE *e;
+	const char *fmt;
+	int n = 0;
+
+	while (_klog_queue != _klog_tete) {
+		e = &_klog[_klog_queue & (KLOG_TAILLE - 1)];
+		fmt = e->fmt;
+		if (fmt == 0) {
+			break;
+		}
+		_DMB();
+		if (brut) {
+			printf("@%08x %08x %08x %08x %08x %08x %08x\n",
+					(uint32_t) fmt, e->ticks, e->cycles,
+					e->args[0], e->args[1], e->args[2], e->args[3]);
+		} else {
+			/* date : ticks, puis cycles ecoules depuis le debut du tick */
+			printf("[%6u.%07u] ", e->ticks, SYSTICK->load - e->cycles);
+			printf(fmt, e->args[0], e->args[1], e->args[2], e->args[3]);
+		}
+		e->fmt = 0;
+		_DMB();
+		_klog_queue++;
+		n++;
+	}
+	return n;
+}
+
+int klog_flush(void) {
+	return klog_vide(0);
+}
+
+int klog_dump(void) {
+	return klog_vide(1);
+}
+
+uint32_t klog_perdus(void) {
+	return _klog_perdus;
+}
+
+void klog_tache(void *arg) {
+	while (1) {
+		klog_flush();
+		delay(1);
+	}
+}
@@ -0,0 +1,77 @@
+/*----------------------------------------------------------------------------*
+ * fichier : klog.h                                                           *
+ * journal binaire differe pour le mini-noyau temps reel                      *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __KLOG_H__
+#define __KLOG_H__
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * nombre d'entrees du journal, doit etre une puissance de 2
+ */
+#define KLOG_TAILLE    64
+
+/*
+ * nombre maximal d'arguments memorises par entree
+ */
+#define KLOG_MAX_ARGS  4
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * KLOG(format, ...)
+ *
+ * Enregistre un message dans le journal sans le formater : seuls l'adresse
+ * du format, la date et les arguments bruts (au plus KLOG_MAX_ARGS mots de
+ * 32 bits) sont copies. Utilisable en section critique et en interruption.
+ * Le format doit etre une chaine constante ; seules les conversions 32 bits
+ * sont permises et les chaines passees pour %s doivent rester valides
+ * jusqu'au formatage.
+ */
+#define KLOG(...) _KLOG_(__VA_ARGS__, 0, 0, 0, 0, 0)
+#define _KLOG_(fmt, a, b, c, d, ...) \
+	klog_write(fmt, (uint32_t) (a), (uint32_t) (b), (uint32_t) (c), \
+			(uint32_t) (d))
+
+void klog_write(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3);
+
+/*
+ * entre  : sans
+ * sortie : nombre d'entrees traitees
+ * description : formate et affiche les entrees en attente, a appeler depuis
+ *               une tache de faible priorite
+ */
+int klog_flush(void);
+
+/*
+ * entre  : sans
+ * sortie : nombre d'entrees traitees
+ * description : affiche les entrees en attente sans les formater, une ligne
+ *               hexadecimale par entree ("@format date cycles args"), pour
+ *               un decodage sur l'hote a partir de la table des chaines de
+ *               l'executable
+ */
+int klog_dump(void);
+
+/*
+ * entre  : sans
+ * sortie : nombre d'entrees perdues faute de place depuis le demarrage
+ */
+uint32_t klog_perdus(void);
+
+/*
+ * tache de vidage du journal : appelle klog_flush a chaque tick
+ * a creer avec la priorite la plus basse
+ */
+void klog_tache(void *arg);
+
+#endif
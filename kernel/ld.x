@@ -13,6 +13,11 @@ __ram = ORIGIN(RAM);
 __eram = ORIGIN(RAM) + LENGTH(RAM);
 __tos = __eram;
 
+/* Taille du tas (kernel/heap.c), redefinissable a l'edition de liens :
+ * -Wl,--defsym=__heap_size=...
+ */
+__heap_size = DEFINED(__heap_size) ? __heap_size : 256K;
+
 SECTIONS {
       .text __boot : AT (__boot) {
         __text = .;
@@ -43,4 +48,11 @@ SECTIONS {
         . = ALIGN(4);
         __ebss = .;
     }
+
+    /* Tas : non initialise, entre les donnees et les piles des taches */
+    .heap (NOLOAD) : ALIGN(8) {
+        __heap = .;
+        . += __heap_size;
+        __eheap = .;
+    }
 }
\ No newline at end of file
@@ -5,24 +5,32 @@
 
 #include "mutex.h"
 
-#include "fifo.h"
+#include "klog.h"
+#include "rwlock.h"
 #include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "../hwsupport/stm32h7xx.h"
+#include <stddef.h>
 #include <stdio.h>
 
-#define NO_OWNER_TASK_ID -1
-
-/*----------------------------------------------------------------------------*
- * declaration des structures                                                 *
- *----------------------------------------------------------------------------*/
+/*
+ * mot de verrouillage : 0 si le mutex est libre, sinon numero du
+ * proprietaire + 1, plus MUTEX_CONTENTION quand la liberation doit passer
+ * par le noyau (taches en attente, plafond, heritage en cours)
+ */
+#define MUTEX_LIBRE         0
+#define MUTEX_CONTENTION    0x100
+#define MUTEX_PROPRIO(v)    (((v) & 0xff) - 1)
 
 /*
- * structure definissant un mutex
+ * un numero de mutex code l'indice dans _mutex (4 bits de poids faible) et
+ * la generation de l'entree (4 bits de poids fort), incrementee a chaque
+ * destruction ; elle ne prend que 15 valeurs, MUTEX_INVALIDE n'est donc
+ * jamais un numero valide
  */
-typedef struct {
-    FIFO wait_queue;	// File d'attente des taches qui veulent prendre ce mutex
-    uint8_t owner_id;    // ID de la tâche qui détient le mutex. NO_OWNER_TASK_ID si libre.
-    int8_t ref_count;    // Compteur de références. -1 si non créer (et donc non libre), 0 si creer et dispo, >0 si acquis.
-} MUTEX;
+#define MUTEX_INDICE(n)     ((n) & 0x0f)
+#define MUTEX_GENERATION(n) ((n) >> 4)
+#define MUTEX_GEN_NB        15
 
 /*----------------------------------------------------------------------------*
  * variables globales internes                                                *
@@ -33,22 +41,255 @@ typedef struct {
  */
 MUTEX _mutex[MAX_MUTEX];
 
+/*
+ * premiere entree libre de _mutex, MAX_MUTEX si la table est pleine
+ */
+static uint8_t _mutex_libre;
+
+/*
+ * heritage de priorite : pour chaque tache, le mutex qu'elle attend et la
+ * liste des mutex qu'elle detient (NULL si aucun). Les mutex sont designes
+ * par adresse : ceux fournis par l'application s'y melent a ceux de la
+ * table. Un mutex pris par le chemin rapide n'est lie a la liste de son
+ * proprietaire qu'a la premiere contention : seuls les mutex attendus ou a
+ * plafond y figurent.
+ */
+static MUTEX *_mutex_attendu[MAX_TACHES_NOYAU];
+static MUTEX *_mutex_detenus[MAX_TACHES_NOYAU];
+
 /*----------------------------------------------------------------------------*
- * definition des fonctions                                                   *
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * retrouve le mutex d'un numero, arrete le noyau s'il n'existe pas ou
+ * s'il a ete detruit depuis (generation differente)
+ */
+static MUTEX *m_verifie(uint8_t n) {
+	register MUTEX *m = &_mutex[MUTEX_INDICE(n)];
+
+	if (!m->cree || m->generation != MUTEX_GENERATION(n)) {
+		printf("Le mutex %d n'a pas encore été créé\n", n);
+		noyau_exit();
+	}
+	return m;
+}
+
+/*
+ * remplace atomiquement le mot de verrouillage s'il vaut attendu
+ * sortie : 1 si le mot a ete remplace, 0 sinon
+ * description : la reservation LDREX est perdue a chaque retour
+ *               d'exception ; une tache preemptee entre LDREX et STREX
+ *               recommence donc avec la valeur a jour
+ */
+static int m_cas(volatile uint32_t *p, uint32_t attendu, uint32_t nouveau) {
+	do {
+		if (_ldrex(p) != attendu) {
+			_clrex();
+			return 0;
+		}
+	} while (_strex(p, nouveau));
+	return 1;
+}
+
+/*----------------------------------------------------------------------------*
+ * heritage de priorite                                                       *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * ajoute le mutex m en tete de la liste des mutex detenus par t
+ */
+static void m_lie(MUTEX *m, uint16_t t) {
+	m->suivant_detenu = _mutex_detenus[t];
+	_mutex_detenus[t] = m;
+	m->lie = 1;
+}
+
+/*
+ * retire le mutex m de la liste des mutex detenus par t
+ */
+static void m_delie(MUTEX *m, uint16_t t) {
+	register MUTEX **k = &_mutex_detenus[t];
+
+	while (*k != m) {
+		k = &(*k)->suivant_detenu;
+	}
+	*k = m->suivant_detenu;
+	m->lie = 0;
+}
+
+/*
+ * releve la priorite du proprietaire t a prio, puis celle du proprietaire
+ * du mutex que t attend, et ainsi de suite (heritage transitif)
+ * s'arrete des qu'une tache est deja au moins aussi prioritaire
+ */
+void m_herite(uint16_t t, uint8_t prio) {
+	register MUTEX *k;
+
+	while (noyau_get_p_tcb(t)->prio > prio) {
+		noyau_change_prio(t, prio);
+		k = _mutex_attendu[t];
+		if (k == NULL || k->protocole != MUTEX_HERITAGE
+				|| k->verrou == MUTEX_LIBRE) {
+			break;
+		}
+		t = MUTEX_PROPRIO(k->verrou);
+	}
+}
+
+/*
+ * recalcule la priorite courante de la tache t : sa priorite de base,
+ * relevee au plafond des mutex MUTEX_PLAFOND qu'elle detient et a celle de
+ * la tache la plus prioritaire en attente sur l'un des mutex MUTEX_HERITAGE
+ * ou des verrous lecteurs/ecrivain qu'elle detient. Si t attend elle-meme un mutex a heritage, le
+ * proprietaire de celui-ci est recalcule a son tour.
+ */
+void m_recalcule(uint16_t t) {
+	register MUTEX *m;
+	uint8_t prio;
+	uint16_t w;
+
+	for (;;) {
+		prio = noyau_get_p_tcb(t)->prio_base;
+		for (m = _mutex_detenus[t]; m != NULL; m = m->suivant_detenu) {
+			if (m->protocole == MUTEX_PLAFOND) {
+				if (m->plafond < prio) {
+					prio = m->plafond;
+				}
+				continue;
+			}
+			if (m->protocole != MUTEX_HERITAGE) {
+				continue;
+			}
+			// la file est triee : la premiere tache est la plus prioritaire
+			w = file_att_premier(&m->wait_queue);
+			if (w != MAX_TACHES_NOYAU && noyau_get_p_tcb(w)->prio < prio) {
+				prio = noyau_get_p_tcb(w)->prio;
+			}
+		}
+		noyau_change_prio(t, rw_prio_heritee(t, prio));
+		m = _mutex_attendu[t];
+		if (m == NULL || m->protocole != MUTEX_HERITAGE
+				|| m->verrou == MUTEX_LIBRE) {
+			break;
+		}
+		t = MUTEX_PROPRIO(m->verrou);
+	}
+}
+
+/*
+ * expiration du delai de la tache t en attente du mutex, appelee par
+ * delay_process apres son retrait de la file : le proprietaire ne doit
+ * plus heriter de sa priorite, et la chaine d'heritage ne doit plus passer
+ * par t
+ */
+static void m_expire(FILE_ATTENTE *f, uint16_t t) {
+	register MUTEX *m = (MUTEX *) ((uint8_t *) f - offsetof(MUTEX, wait_queue));
+
+	_mutex_attendu[t] = NULL;
+	if (m->verrou != MUTEX_LIBRE && m->protocole == MUTEX_HERITAGE) {
+		m_recalcule(MUTEX_PROPRIO(m->verrou));
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * attribution et transmission, en section critique                           *
  *----------------------------------------------------------------------------*/
 
 /*
- * /!!!!\ NOTE IMPORTANTE /!!!!\
- * pour faire les verifications de file, on pourra utiliser la variable de
- * file fifo_taille et la mettre a -1 dans le cas ou la file n'est pas
- * utilisee
+ * Protocole du plafond : la tâche ne doit pas être plus prioritaire que le
+ * plafond, sinon l'exclusion n'est plus garantie ; arrête le noyau, que le
+ * mutex soit libre ou non
+ */
+static void m_verifie_plafond(MUTEX *m, uint16_t t) {
+	if (m->protocole == MUTEX_PLAFOND
+			&& noyau_get_p_tcb(t)->prio_base < m->plafond) {
+		printf("Tache %d plus prioritaire que le plafond du mutex %p\n",
+				t, (void *) m);
+		noyau_exit();
+	}
+}
+
+/*
+ * attribue le mutex libre m a la tache t
+ */
+static void m_prend(MUTEX *m, uint16_t t) {
+	if (m->protocole == MUTEX_PLAFOND) {
+		// Plafond immédiat : la tâche monte au plafond dès
+		// l'acquisition, la libération passera par le noyau
+		m->verrou = (t + 1) | MUTEX_CONTENTION;
+		m_lie(m, t);
+		if (m->plafond < noyau_get_p_tcb(t)->prio) {
+			noyau_change_prio(t, m->plafond);
+		}
+	} else {
+		m->verrou = t + 1;
+	}
+}
+
+/*
+ * prepare l'attente de t sur le mutex detenu m ; l'appelant place ensuite
+ * t dans m->wait_queue
+ * Le bit de contention force le propriétaire à libérer par le noyau ;
+ * s'il était entre LDREX et STREX, son STREX échoue.
  */
+static void m_contention(MUTEX *m, uint16_t t) {
+	uint32_t v = m->verrou;
+
+	m->verrou = v | MUTEX_CONTENTION;
+	if (!m->lie) {
+		m_lie(m, MUTEX_PROPRIO(v));
+	}
+	// Le propriétaire hérite de notre priorité pendant l'attente.
+	_mutex_attendu[t] = m;
+	if (m->protocole == MUTEX_HERITAGE) {
+		m_herite(MUTEX_PROPRIO(v), noyau_get_p_tcb(t)->prio);
+	}
+}
+
+/*
+ * libere le mutex m detenu par tc : il est transmis à la tâche en attente
+ * la plus prioritaire, et la priorité de tc est recalculée. L'appelant
+ * appelle schedule().
+ */
+static void m_transmet(MUTEX *m, uint16_t tc) {
+    if (m->lie) {
+        m_delie(m, tc);
+    }
+    // Si des tâches attendent, attribuer le mutex à la plus prioritaire
+    if (file_att_premier(&m->wait_queue) != MAX_TACHES_NOYAU) {
+        uint16_t new_task = attente_reveille(&(m->wait_queue), ATT_OK);
+
+        _mutex_attendu[new_task] = NULL;
+        if (m->protocole == MUTEX_PLAFOND
+                || file_att_premier(&m->wait_queue) != MAX_TACHES_NOYAU) {
+            m->verrou = (new_task + 1) | MUTEX_CONTENTION;
+            m_lie(m, new_task);
+        } else {
+            m->verrou = new_task + 1;
+        }
+        // Le nouveau propriétaire hérite des tâches qui attendent encore,
+        // ou monte au plafond
+        m_recalcule(new_task);
+        KLOG("reveille : %d\n", new_task);
+    } else {
+        m->verrou = MUTEX_LIBRE;
+    }
+    // Retour à la priorité de base, ou à celle héritée des autres
+    // mutex encore détenus
+    m_recalcule(tc);
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
 
 /*
  * initialise les mutex du systeme
  * entre  : sans
  * sortie : sans
- * description : initialise le tableau des mutex de telle manière qu'ils soient tous disponibles
+ * description : initialise le tableau des mutex de telle manière qu'ils soient tous disponibles,
+ *               chaines dans la liste des entrees libres
  */
 void m_init(void) {
 	register MUTEX *m = _mutex;
@@ -56,98 +297,173 @@ void m_init(void) {
 
 	for (j = 0; j < MAX_MUTEX; j++)
 	{
-		m->owner_id = NO_OWNER_TASK_ID;
-		m->ref_count = -1;
+		m->verrou = MUTEX_LIBRE;
+		m->cree = 0;
+		m->generation = 0;
+		m->suivant_libre = j + 1;
 		m++;
 	}
+	_mutex_libre = 0;
+	for (j = 0; j < MAX_TACHES_NOYAU; j++)
+	{
+		_mutex_attendu[j] = NULL;
+		_mutex_detenus[j] = NULL;
+	}
+}
+
+/*
+ * initialise un mutex fourni par l'application
+ * entre  : mutex, protocole (MUTEX_AUCUN, MUTEX_HERITAGE, MUTEX_PLAFOND),
+ *          priorite plafond, ignoree hors MUTEX_PLAFOND
+ * sortie : sans
+ * description : aucune table n'est parcourue, le nombre de mutex n'est
+ *               limite que par la memoire
+ */
+void m_init_static(MUTEX *m, uint8_t protocole, uint8_t plafond) {
+	// intiialise une file d'attente de toutes les taches cherchant à obtenir ce mutex
+	file_att_init(&(m->wait_queue));
+	m->wait_queue.expire = m_expire;
+	m->verrou = MUTEX_LIBRE;
+	m->imbrique = 0;
+	m->lie = 0;
+	m->protocole = protocole;
+	m->plafond = plafond;
+	m->cree = 1;
 }
 
 /*
  * cree un mutex
  * entre  : sans
- * sortie : Retourne le numéro de mutex si ok, MAX_MUTEX sinon.
+ * sortie : Retourne le numéro de mutex si ok, MUTEX_INVALIDE sinon.
  * description : Crée un mutex.
  */
 uint8_t m_create() {
-	register unsigned n = 0;
-	register MUTEX *m = &_mutex[n];
+	return m_create_proto(MUTEX_HERITAGE, 0);
+}
+
+/*
+ * Cree un mutex avec le protocole choisi
+ * entre  : protocole (MUTEX_AUCUN, MUTEX_HERITAGE, MUTEX_PLAFOND),
+ *          priorite plafond, ignoree hors MUTEX_PLAFOND
+ * sortie : numero du mutex, MUTEX_INVALIDE si aucun n'est libre
+ * description : prend la premiere entree de la liste des entrees libres,
+ *               en temps constant
+ */
+uint8_t m_create_proto(uint8_t protocole, uint8_t plafond) {
+	register MUTEX *m;
+	uint8_t n;
 
 	_lock_();
-	/* Rechercher un mutex libre */
-	while(m->ref_count != -1 && n < MAX_MUTEX)
-	{
-		n++;
-		m = &_mutex[n];
-	}
-	if (n < MAX_MUTEX)
-	{
-		// intiialise une file d'attente de toutes les taches cherchant à obtenir ce mutex
-		fifo_init(&(m->wait_queue)); 
-		m->ref_count = 0;
-		m->owner_id = NO_OWNER_TASK_ID;
-	}
-	else
+	n = _mutex_libre;
+	if (n == MAX_MUTEX)
 	{
-		n = MAX_MUTEX;
+		_unlock_();
 		printf("Volonté de creer un mutex mais le tableau est plein");
+		return MUTEX_INVALIDE;
 	}
+	m = &_mutex[n];
+	_mutex_libre = m->suivant_libre;
+	m_init_static(m, protocole, plafond);
 	_unlock_();
 
-	return n;
+	return n | (m->generation << 4);
 }
 
 
 /*
- * Acquiert le mutex n.
+ * chemin lent de l'acquisition
+ * appelee en section critique (un seul niveau), la relache : la tache
+ * s'endort a la sortie de la section critique
+ */
+static uint8_t m_acquiert(MUTEX *m, uint32_t timeout) {
+	uint16_t tc = noyau_get_tc();
+
+	if (!m->cree) {
+		printf("Le mutex %p n'a pas encore été créé\n", (void *) m);
+		noyau_exit();
+	}
+	if ((m->verrou & 0xff) == tc + 1u) {
+		m->imbrique++;
+		_unlock_();
+		return ATT_OK;
+	}
+	m_verifie_plafond(m, tc);
+
+	// Libre : mutex à plafond, ou libéré depuis le chemin rapide
+	if (m->verrou == MUTEX_LIBRE) {
+		m_prend(m, tc);
+		_unlock_();
+		return ATT_OK;
+	}
+
+	if (timeout == 0) {
+		_unlock_();
+		return ATT_TIMEOUT;
+	}
+
+	// Il faut attendre qu'il se libère : m_release nous le transmettra
+	// directement.
+	m_contention(m, tc);
+	// En cas d'expiration, m_expire a déjà rendu au propriétaire sa
+	// priorité
+	attente(&(m->wait_queue), timeout);
+	_unlock_();
+
+	return attente_etat();
+}
+
+/*
+ * Acquiert le mutex n, en attendant au plus timeout ticks.
  * entre  : numero du mutex a prendre
- * sortie : sans
+ *          delai d'attente maximal en ticks (0 : pas d'attente,
+ *          ATT_INFINI : pas de limite)
+ * sortie : ATT_OK si le mutex est acquis, ATT_TIMEOUT si le delai a expire
  * description :
  * 		Acquiert le mutex n. Les mutex sont ré-entrants :
  * 		si une tâche ré-acquiert un mutex dont elle est
  * 		déjà propriétaire, ce n'est pas une erreur,
- * 		elle ne dormira pas dessus
+ * 		elle ne dormira pas dessus.
+ * 		Un mutex libre (hors plafond) est pris par un seul
+ * 		LDREX/STREX, sans entrer en section critique.
  */
-void m_acquire(uint8_t n) {
-	if(n < 0 || n >= MAX_MUTEX ){
-		printf("L'index du mutex n'est pas valide");
-		noyau_exit();
+uint8_t m_acquire_timeout_p(MUTEX *m, uint32_t timeout) {
+	uint16_t tc = noyau_get_tc();
+	uint32_t moi = tc + 1;
+
+	// Chemin rapide : mutex libre, ou déjà à nous
+	if (m->cree && m->protocole != MUTEX_PLAFOND
+			&& m_cas(&m->verrou, MUTEX_LIBRE, moi)) {
+		_DMB();
+		return ATT_OK;
 	}
-
-	register MUTEX *m = &_mutex[n];
-
-	if(m->ref_count==-1){
-		printf("Le mutex n'as pas encore été créer m_aquaire");
-		noyau_exit();
+	if ((m->verrou & 0xff) == moi) {
+		m->imbrique++;
+		return ATT_OK;
 	}
 
 	_lock_();
-	// Check si mutex bien deja créer (sinon erreur donc crash system)
-	if (m->ref_count == -1){ // supprimer redondonce 
-		_unlock_();
-		printf("Volonté d'aquérir un mutex meme pas créer");
-		noyau_exit();
-	}
+	return m_acquiert(m, timeout);
+}
 
-	// Si non libre
-	if (m->ref_count != 0){
-		// A part si on est justement le propriétaire (aucquel cas on augmente notre ref_count)
-		if(m->owner_id == noyau_get_tc()){ 
-			// si la tache courante est en possession du mutex et le reprend
-			m->ref_count++;
+/*
+ * par numero : le numero est verifie dans la meme section critique que
+ * l'acquisition, une entree fermee puis reattribuee entre les deux est
+ * donc refusee
+ */
+uint8_t m_acquire_timeout(uint8_t n, uint32_t timeout) {
+	_lock_();
+	return m_acquiert(m_verifie(n), timeout);
+}
 
-		}else{
-			// Alors c'est qu'il faut attendre qu'il se libère
-			fifo_ajoute(&(m->wait_queue), noyau_get_tc());
-			dort();
+/*
+ * Acquiert le mutex n, sans limite de temps.
+ */
+void m_acquire_p(MUTEX *m) {
+	m_acquire_timeout_p(m, ATT_INFINI);
+}
 
-		}
-	}else{
-		// Si libre
-		m->owner_id = noyau_get_tc();
-		m->ref_count++;
-	}
-	_unlock_();
-	return;
+void m_acquire(uint8_t n) {
+	m_acquire_timeout(n, ATT_INFINI);
 }
 
 /*
@@ -155,81 +471,140 @@ void m_acquire(uint8_t n) {
  * entre  : numero du mutex a liberer
  * sortie : sans
  * description :
- *      Libere le mutex n.
+ *      Libere le mutex n. Sans contention, un seul LDREX/STREX ;
+ *      sinon le mutex est transmis à la tâche en attente la plus
+ *      prioritaire et la priorité du propriétaire est recalculée.
  */
-void m_release(uint8_t n) {
-    if (n < 0 || n >= MAX_MUTEX) {
-        printf("L'index du mutex n'est pas valide\n");
-        noyau_exit();
-    }
-    register MUTEX *m = &_mutex[n];
+void m_release_p(MUTEX *m) {
+    uint16_t tc = noyau_get_tc();
+    uint32_t moi = tc + 1;
 
-    if (m->ref_count == -1) {
-        printf("Le mutex n'a pas encore été créé m_release\n");
+    if ((m->verrou & 0xff) != moi) {
+        printf("Le processus courant (%d) ne détient pas le mutex (owner : %d)\n",
+               tc, MUTEX_PROPRIO(m->verrou));
         noyau_exit();
     }
 
-    if (m->owner_id != noyau_get_tc()) {
-        printf("Le processus courant (%d) ne détient pas le mutex (owner : %d)\n", 
-               noyau_get_tc(), m->owner_id);
-        noyau_exit();
+    // Chemin rapide : ré-acquisition, ou personne n'attend
+    if (m->imbrique) {
+        m->imbrique--;
+        return;
+    }
+    _DMB();
+    if (m_cas(&m->verrou, moi, MUTEX_LIBRE)) {
+        return;
     }
 
     _lock_();
+    m_transmet(m, tc);
+    schedule();             // The new owner may preempt us
 
-    m->ref_count--;
-    // Si la tâche a complètement fini d'utiliser la ressource
-    if (m->ref_count == 0) {
-        m->owner_id = NO_OWNER_TASK_ID; // Mutex is now free
-        // Si des tâches attendent, attribuer le mutex à la première
-        if (m->wait_queue.fifo_taille > 0) {
-            uint8_t new_task;
-            if (fifo_retire(&(m->wait_queue), &new_task) == 0) {
-                printf("Erreur dans fifo_retire dans m_release\n");
-                _unlock_();
-                noyau_exit();
-            }
-            m->owner_id = new_task; // Assign new owner
-            m->ref_count = 1;       // New owner has acquired the mutex
-            printf("reveille : %d\n", (uint16_t)new_task);
-            reveille((uint16_t)new_task); // Wake the new task
-        }
-    }
+    _unlock_();
+}
 
+void m_release(uint8_t n) {
+    _lock_();
+    m_release_p(m_verifie(n));
     _unlock_();
 }
 
 
 /*
- * ferme un mutex pour qu'il puisse etre reutilise
- * entre  : numero du mutex a fermer
+ * ferme un mutex
+ * entre  : mutex a fermer
  * sortie : sans
  * description : ferme un mutex
  *               en cas d'erreur, le noyau doit etre arrete
  */
-void m_destroy(uint8_t n) {
-	if(n < 0 || n >= MAX_MUTEX ){
-		printf("L'index du mutex n'est pas valide");
+void m_destroy_p(MUTEX *m) {
+	_lock_();
+	if (m->verrou != MUTEX_LIBRE) {
+		printf("Le mutex est encore détenu par une tache (%d)", MUTEX_PROPRIO(m->verrou));
 		noyau_exit();
 	}
-	register MUTEX *m = &_mutex[n];
+	file_att_init(&(m->wait_queue));
+	m->cree = 0;
+	_unlock_();
+}
 
-	if(m->ref_count==-1){
-		printf("Le mutex n'as pas encore été créer m_destroy");
-		noyau_exit();
-	}
-	if(m->ref_count>0){
-		printf("Le mutex est encore détenu par une tache (%d)", m->owner_id);
-		noyau_exit();
-	}
+/*
+ * ferme un mutex de la table pour qu'il puisse etre reutilise
+ * entre  : numero du mutex a fermer
+ * sortie : sans
+ * description : rend l'entree a la liste des entrees libres ; les anciens
+ *               numeros deviennent invalides
+ */
+void m_destroy(uint8_t n) {
+	register MUTEX *m;
 
+	// une seule section critique : deux destructions du meme numero ne
+	// peuvent pas rendre l'entree deux fois
 	_lock_();
+	m = m_verifie(n);
+	m_destroy_p(m);
+	m->generation = (m->generation + 1) % MUTEX_GEN_NB;
+	m->suivant_libre = _mutex_libre;
+	_mutex_libre = MUTEX_INDICE(n);
+	_unlock_();
+}
 
+/*
+ * adresse d'un mutex de la table
+ * entre  : numero du mutex
+ * sortie : adresse, pour les fonctions a suffixe _p et cv_wait
+ */
+MUTEX *m_adresse(uint8_t n) {
+	return m_verifie(n);
+}
 
-	 fifo_init(&(m->wait_queue));
-	 m->ref_count=-1;
-	 m->owner_id=NO_OWNER_TASK_ID;
-	_unlock_();
+/*
+ * libere completement le mutex m detenu par la tache courante
+ * entre  : mutex
+ * sortie : nombre de re-acquisitions a restituer par m_reprend
+ * description : pour cv_wait, en section critique ; la commutation a
+ *               lieu a la sortie de la section critique
+ */
+uint8_t m_libere_tout(MUTEX *m) {
+	uint16_t tc = noyau_get_tc();
+	uint32_t moi = tc + 1;
+	uint8_t imbrique = m->imbrique;
+
+	if ((m->verrou & 0xff) != moi) {
+		printf("Le processus courant (%d) ne détient pas le mutex (owner : %d)\n",
+		       tc, MUTEX_PROPRIO(m->verrou));
+		noyau_exit();
+	}
+	m->imbrique = 0;
+	_DMB();
+	if (!m_cas(&m->verrou, moi, MUTEX_LIBRE)) {
+		m_transmet(m, tc);
+	}
+	schedule();
+	return imbrique;
 }
 
+/*
+ * restitue les re-acquisitions apres que la tache courante a repris m
+ */
+void m_reprend(MUTEX *m, uint8_t imbrique) {
+	m->imbrique = imbrique;
+}
 
+/*
+ * transfere sur le mutex m la tache t en attente dans la file f
+ * entre  : mutex, file de l'objet attendu par t, tache
+ * sortie : 1 si m etait libre : t le recoit et est reveillee,
+ *          0 si t attend desormais m, sans limite de temps
+ * description : en section critique, sans commutation
+ */
+uint8_t m_transfere(MUTEX *m, FILE_ATTENTE *f, uint16_t t) {
+	m_verifie_plafond(m, t);
+	if (m->verrou == MUTEX_LIBRE) {
+		m_prend(m, t);
+		attente_termine(f, t, ATT_OK);
+		return 1;
+	}
+	m_contention(m, t);
+	attente_deplace(f, &m->wait_queue, t);
+	return 0;
+}
@@ -10,8 +10,32 @@
 
 #include <stdint.h>
 
+#include "noyau_prio.h"
 
-#define MAX_MUTEX 16
+
+#define MAX_MUTEX 16        /* au plus 16 : le numéro code l'indice sur 4 bits */
+#define MUTEX_INVALIDE 0xff /* retourné par m_create quand la table est pleine */
+
+/* Protocoles des mutex */
+#define MUTEX_AUCUN     0   /* transmission FIFO, sans changement de priorité         */
+#define MUTEX_HERITAGE  1   /* héritage de priorité transitif (m_create)              */
+#define MUTEX_PLAFOND   2   /* plafond immédiat : priorité relevée dès l'acquisition  */
+
+/* Mutex. Une application peut l'allouer elle-même (m_init_static) et utiliser les fonctions à
+ * suffixe _p ; les champs ne doivent pas être modifiés directement.
+ */
+typedef struct MUTEX {
+    volatile uint32_t verrou;   // Mot de verrouillage, modifié par LDREX/STREX hors section critique
+    FILE_ATTENTE wait_queue;	// File d'attente des taches qui veulent prendre ce mutex, par priorite
+    struct MUTEX *suivant_detenu; // Mutex suivant dans la liste des mutex détenus. NULL en fin de liste.
+    uint8_t imbrique;    // Nombre de ré-acquisitions par le propriétaire
+    uint8_t cree;        // 0 si le mutex est libre
+    uint8_t lie;         // 1 si le mutex est dans la liste des mutex détenus par son propriétaire
+    uint8_t protocole;   // MUTEX_AUCUN, MUTEX_HERITAGE ou MUTEX_PLAFOND
+    uint8_t plafond;     // Priorité plafond (MUTEX_PLAFOND uniquement)
+    uint8_t generation;  // Table _mutex : génération de l'entrée
+    uint8_t suivant_libre; // Table _mutex : entrée libre suivante
+} MUTEX;
 
 /* m_init
  *
@@ -22,20 +46,93 @@ void m_init(void);
 
 /* m_create
  *
- * Crée un mutex. Retourne le numéro de mutex si ok, MAX_MUTEX sinon.
+ * Crée un mutex. Retourne le numéro de mutex si ok, MUTEX_INVALIDE sinon.
+ * La création est en temps constant. Le numéro contient la génération de l'entrée : un numéro
+ * utilisé après m_destroy est refusé (arrêt du noyau), même si l'entrée a été réattribuée.
  *
  */
 uint8_t m_create(void);
 
+/* m_create_proto
+ *
+ * Crée un mutex avec le protocole choisi. Pour MUTEX_PLAFOND, plafond est la priorité de la tâche la
+ * plus prioritaire qui utilisera le mutex : la tâche qui l'acquiert y est relevée immédiatement et
+ * revient à sa priorité à la libération. Sur un seul coeur à priorités fixes, cela exclut
+ * l'interblocage et le blocage en chaîne, et l'acquisition ne touche jamais à la file d'attente tant
+ * que le propriétaire ne se suspend pas. Une tâche plus prioritaire que le plafond qui tente
+ * d'acquérir le mutex arrête le noyau.
+ * Retourne le numéro de mutex si ok, MUTEX_INVALIDE sinon.
+ *
+ */
+uint8_t m_create_proto(uint8_t protocole, uint8_t plafond);
+
 /* m_acquire
  *
  * Acquiert le mutex n. Les mutex sont ré-entrants : si une tâche ré-acquiert un mutex dont elle est
  * déjà propriétaire, ce n'est pas une erreur, elle ne dormira pas dessus.
  *
+ * Héritage de priorité : tant qu'une tâche attend le mutex, son propriétaire s'exécute au moins à
+ * la priorité de cette tâche. L'héritage est transitif (si le propriétaire attend lui-même un
+ * autre mutex, le propriétaire de celui-ci est relevé aussi). A la libération, la tâche reprend
+ * sa priorité de base, ou la plus forte priorité héritée des mutex qu'elle détient encore.
+ *
  */
 void m_acquire(uint8_t n);
+
+/* m_acquire_timeout
+ *
+ * Comme m_acquire, mais attend au plus timeout ticks (0 : pas d'attente,
+ * ATT_INFINI : pas de limite). Retourne ATT_OK si le mutex est acquis,
+ * ATT_TIMEOUT si le délai a expiré. Un mutex détenu ne peut pas être détruit,
+ * l'attente ne se termine donc jamais par ATT_DETRUIT.
+ *
+ */
+uint8_t m_acquire_timeout(uint8_t n, uint32_t timeout);
 void m_release(uint8_t n);
 void m_destroy(uint8_t n);
 
+/* m_init_static
+ *
+ * Initialise un mutex fourni par l'application (variable statique, membre d'une structure...) ;
+ * les fonctions à suffixe _p l'utilisent par adresse, sans passer par la table.
+ *
+ *     static MUTEX verrou_bus;
+ *     m_init_static(&verrou_bus, MUTEX_HERITAGE, 0);
+ *     m_acquire_p(&verrou_bus);
+ *
+ */
+void m_init_static(MUTEX *m, uint8_t protocole, uint8_t plafond);
+void m_acquire_p(MUTEX *m);
+uint8_t m_acquire_timeout_p(MUTEX *m, uint32_t timeout);
+void m_release_p(MUTEX *m);
+void m_destroy_p(MUTEX *m);
+
+/* m_adresse
+ *
+ * Adresse du mutex n de la table, pour les fonctions à suffixe _p et cv_wait.
+ *
+ */
+MUTEX *m_adresse(uint8_t n);
+
+/* m_herite, m_recalcule
+ *
+ * Usage interne du noyau (rwlock.c), en section critique : relève la tâche t à prio en suivant les
+ * mutex qu'elle attend, ou recalcule sa priorité à partir des objets qu'elle détient.
+ *
+ */
+void m_herite(uint16_t t, uint8_t prio);
+void m_recalcule(uint16_t t);
+
+/* m_libere_tout, m_reprend, m_transfere
+ *
+ * Usage interne du noyau (cond.c), en section critique : libère le mutex quel que soit le niveau
+ * de ré-acquisition puis le restitue, et fait passer une tâche en attente d'un autre objet
+ * directement sur la file du mutex (ou lui attribue le mutex s'il est libre).
+ *
+ */
+uint8_t m_libere_tout(MUTEX *m);
+void m_reprend(MUTEX *m, uint8_t imbrique);
+uint8_t m_transfere(MUTEX *m, FILE_ATTENTE *f, uint16_t t);
+
 
 #endif /* KERNEL_MUTEX_H_ */
@@ -0,0 +1,130 @@
+/*----------------------------------------------------------------------------*
+ * fichier : notify.c                                                         *
+ * notifications directes aux taches pour le mini-noyau temps reel            *
+ *----------------------------------------------------------------------------*/
+
+#include "notify.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * met a jour le mot de notification et reveille la tache si elle attend
+ * sortie : -1 si rien n'a ete ecrit, 1 si la tache a ete reveillee, 0 sinon
+ * appelee en section critique, sans commutation
+ */
+static int notify_ecrit(uint16_t tache, uint32_t valeur, uint8_t action) {
+	NOYAU_TCB *p = noyau_get_p_tcb(tache);
+
+	if (p->status == NCREE) {
+		printf("Notification d'une tache non creee : %d\n", tache);
+		noyau_exit();
+	}
+
+	switch (action) {
+	case NOTIF_BITS:
+		p->notif |= valeur;
+		break;
+	case NOTIF_COMPTE:
+		p->notif++;
+		break;
+	case NOTIF_SI_LU:
+		if (p->notif_recue) {
+			return -1;
+		}
+		/* pas de break */
+	case NOTIF_ECRASE:
+		p->notif = valeur;
+		break;
+	default:
+		break;
+	}
+	p->notif_recue = 1;
+
+	return attente_reveille(&p->notif_file, ATT_OK) != MAX_TACHES_NOYAU;
+}
+
+/*
+ * attend que la condition de la tache courante soit vraie
+ * appelee en section critique
+ */
+static uint8_t notify_attend(NOYAU_TCB *p, int condition, uint32_t timeout) {
+	if (condition) {
+		return ATT_OK;
+	}
+	if (timeout == 0) {
+		return ATT_TIMEOUT;
+	}
+	attente(&p->notif_file, timeout);
+	_unlock_();		/* commutation, reprise au reveil */
+	_lock_();
+	return attente_etat();
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+int notify(uint16_t tache, uint32_t valeur, uint8_t action) {
+	int r;
+
+	_lock_();
+	r = notify_ecrit(tache, valeur, action);
+	if (r > 0) {
+		schedule();
+	}
+	_unlock_();
+
+	return r >= 0;
+}
+
+int notify_from_isr(uint16_t tache, uint32_t valeur, uint8_t action, uint8_t *reveil) {
+	int r;
+
+	_lock_();
+	r = notify_ecrit(tache, valeur, action);
+	if (r > 0) {
+		*reveil = 1;
+	}
+	_unlock_();
+
+	return r >= 0;
+}
+
+uint8_t notify_wait(uint32_t masque, uint32_t timeout, uint32_t *valeur) {
+	NOYAU_TCB *p = noyau_get_p_tcb(noyau_get_tc());
+	uint8_t etat;
+
+	_lock_();
+	etat = notify_attend(p, p->notif_recue, timeout);
+	if (valeur) {
+		*valeur = p->notif;
+	}
+	if (etat == ATT_OK) {
+		p->notif &= ~masque;
+		p->notif_recue = 0;
+	}
+	_unlock_();
+
+	return etat;
+}
+
+uint32_t notify_take(uint32_t timeout) {
+	NOYAU_TCB *p = noyau_get_p_tcb(noyau_get_tc());
+	uint32_t valeur = 0;
+
+	_lock_();
+	/* un NOTIF_SIGNAL peut reveiller la tache sans rien compter */
+	if (notify_attend(p, p->notif != 0, timeout) == ATT_OK && p->notif != 0) {
+		valeur = p->notif--;
+		p->notif_recue = (p->notif != 0);
+	}
+	_unlock_();
+
+	return valeur;
+}
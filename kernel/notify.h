@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------*
+ * fichier : notify.h                                                         *
+ * notifications directes aux taches pour le mini-noyau temps reel            *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __NOTIFY_H__
+#define __NOTIFY_H__
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * action de notify sur le mot de notification de la tache
+ */
+#define NOTIF_SIGNAL     0   // le mot n'est pas modifie (signal binaire)
+#define NOTIF_BITS       1   // mot |= valeur (ensemble de bits)
+#define NOTIF_COMPTE     2   // mot += 1 (signal a compte, valeur ignoree)
+#define NOTIF_ECRASE     3   // mot = valeur
+#define NOTIF_SI_LU      4   // mot = valeur si la notification precedente a ete lue
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * chaque tache possede un mot de notification de 32 bits dans son TCB :
+ * aucun objet a creer. Contrairement a reveille(), une notification envoyee
+ * alors que la tache n'attend pas est memorisee.
+ */
+
+/*
+ * notifie une tache
+ * retourne 1, ou 0 si NOTIF_SI_LU n'a pas pu ecrire
+ * notify_from_isr ne commute pas : elle met *reveil a 1 si la tache a ete
+ * reveillee, la routine appelle schedule_isr(reveil) en sortie
+ */
+int notify(uint16_t tache, uint32_t valeur, uint8_t action);
+int notify_from_isr(uint16_t tache, uint32_t valeur, uint8_t action, uint8_t *reveil);
+
+/*
+ * attend une notification, au plus timeout ticks (0 : pas d'attente,
+ * ATT_INFINI : pas de limite)
+ * retourne ATT_OK ou ATT_TIMEOUT ; si valeur n'est pas nul, il recoit le
+ * mot de notification, dont les bits de masque sont ensuite effaces
+ */
+uint8_t notify_wait(uint32_t masque, uint32_t timeout, uint32_t *valeur);
+
+/*
+ * usage en semaphore a compte avec NOTIF_COMPTE : attend que le mot soit
+ * non nul et le decremente
+ * retourne la valeur du mot avant decrement, 0 si le delai a expire ou si
+ * la tache a ete reveillee par une notification qui ne compte pas
+ */
+uint32_t notify_take(uint32_t timeout);
+
+#endif
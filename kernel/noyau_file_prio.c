@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include "noyau_file_prio.h"
+#include "noyau_prio.h"
 // recuperation du bon fichier selon l'architecture pour la fonction printf
 #include "../io/serialio.h"
 
@@ -18,16 +19,23 @@
 /*
  * tableau qui stocke les taches
  * indice = numero de tache
- * valeur = tache suivante
+ * valeur = tache suivante dans la file circulaire de sa priorite courante
  */
-static uint16_t _file[MAX_PRIO][MAX_TACHES_FILE];
+static uint16_t _file[MAX_TACHES_NOYAU];
 
 /*
- * index de queue
+ * index de queue de chaque priorite
  * valeur de l'index de la tache en cours d'execution
  * pointe sur la prochaine tache a activer
  */
-static uint16_t _queue[MAX_TACHES_FILE];
+static uint16_t _queue[MAX_PRIO];
+
+/*
+ * priorite courante d'une tache
+ */
+static inline uint16_t file_prio(uint16_t n) {
+	return noyau_get_p_tcb(n)->prio;
+}
 
 /*
  * initialise la file
@@ -38,7 +46,7 @@ static uint16_t _queue[MAX_TACHES_FILE];
 void file_init(void) {
 	uint16_t i;
 
-	for (i=0; i<MAX_TACHES_FILE; i++) {
+	for (i=0; i<MAX_PRIO; i++) {
 		_queue[i] = F_VIDE;
 	}
 }
@@ -47,23 +55,19 @@ void file_init(void) {
  * ajoute une tache dans la file
  * entre  : n numero de la tache a ajouter
  * sortie : sans
- * description : ajoute la tache n en fin de file
+ * description : ajoute la tache n en fin de file de sa priorite courante
  */
 void file_ajoute(uint16_t n) {
-	uint16_t num_file, num_t, *q, *f;
+	uint16_t *q = &_queue[file_prio(n)];
 
-	num_file = (n >> 3);
-	num_t = n & 7;
-	q = &_queue[num_file];
-	f = &_file[num_file][0];
     if (*q == F_VIDE) {
-        f[num_t] = num_t;
+        _file[n] = n;
     } else {
-        f[num_t] = f[*q];
-        f[*q] = num_t;
+        _file[n] = _file[*q];
+        _file[*q] = n;
     }
 
-    *q = num_t;
+    *q = n;
 }
 
 /*
@@ -71,31 +75,18 @@ void file_ajoute(uint16_t n) {
  * entre  : t numero de la tache a retirer
  * sortie : sans
  * description : retire la tache t de la file. L'ordre de la file n'est pas
-                 modifie
+                 modifie, la queue pointe sur la tache qui precedait t
  */
 void file_retire(uint16_t t) {
-	uint16_t num_file, num_t, *q, *f;
-
-	num_file = t >> 3;
-	num_t    = t & 7;
-	q = &_queue[num_file];
-	f = &_file[num_file][0];
+	uint16_t *q = &_queue[file_prio(t)];
 
-    if (*q == (f[*q])) {
+    if (_file[t] == t) {
         *q = F_VIDE;
     } else {
-        if (num_t == *q) {
-            *q = f[*q];
-            while (f[*q] != num_t) {
-                *q = f[*q];
-            }
-            f[*q] = f[num_t];
-        } else {
-            while (f[*q] != num_t) {
-                *q = f[*q];
-            }
-            f[*q] = f[f[*q]];
+        while (_file[*q] != t) {
+            *q = _file[*q];
         }
+        _file[*q] = _file[t];
     }
 }
 
@@ -109,11 +100,11 @@ uint16_t file_suivant(void) {
 	uint16_t prio;
 	uint16_t id;
 
-	for (prio = 0; prio < MAX_TACHES_FILE; ++prio) {
+	for (prio = 0; prio < MAX_PRIO; ++prio) {
 		if (_queue[prio] != F_VIDE) {
-			id = _file[prio][_queue[prio]];
+			id = _file[_queue[prio]];
 			_queue[prio] = id;
-			return (id | prio << 3);
+			return (id);
 		}
 	}
 
@@ -128,7 +119,7 @@ uint16_t file_suivant(void) {
  */
 void file_affiche_queue() {
 	uint16_t i;
-	for (i=0; i < MAX_TACHES_FILE; i++){
+	for (i=0; i < MAX_PRIO; i++){
 		 printf("_queue[%d] = %d\n", i, _queue[i]);
 	}
 }
@@ -142,15 +133,15 @@ void file_affiche_queue() {
 void file_affiche() {
 	uint16_t i,j;
 
-    for (j=0; j < MAX_TACHES_FILE; j++){
+    for (j=0; j < MAX_TACHES_NOYAU; j += MAX_TACHES_FILE){
 		printf("Tache   | ");
-		for (i = 0; i < MAX_TACHES_FILE; i++) {
+		for (i = j; i < j + MAX_TACHES_FILE; i++) {
 			printf("%03d | ", i);
 		}
 
 		printf("\nSuivant | ");
-		for (i = 0; i < MAX_TACHES_FILE; i++) {
-			printf("%03d | ", _file[j][i]);
+		for (i = j; i < j + MAX_TACHES_FILE; i++) {
+			printf("%03d | ", _file[i]);
 		}
 		printf("\n");
     }
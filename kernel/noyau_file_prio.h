@@ -25,11 +25,16 @@
  * numero de tache impossible, utilise pour savoir si la file est initialisee
  * ou non
  */
-#define F_VIDE      MAX_TACHES_FILE
+#define F_VIDE      MAX_TACHES_NOYAU
 
 /*----------------------------------------------------------------------------*
  * prototypes des fonctions de gestion de la file                             *
  * voir le fichier noyau_file.c pour avoir le comportement des fonctions      *
+ *                                                                            *
+ * une tache est rangee dans la file de sa priorite courante (champ prio de   *
+ * son contexte), qui peut differer de la priorite codee dans son numero      *
+ * (heritage de priorite) : la priorite d'une tache presente dans la file ne  *
+ * doit changer qu'au travers de noyau_change_prio                            *
  *----------------------------------------------------------------------------*/
 
 void file_init(void);
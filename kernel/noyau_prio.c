@@ -31,6 +31,9 @@ NOYAU_TCB  _noyau_tcb[MAX_TACHES_NOYAU]; /* tableau des contextes
 volatile uint16_t _tache_c;        /* numéro de tache courante              */
 uint32_t _tos;                     /* adresse du sommet de pile des tâches  */
 uint8_t _timer_event = 0;          /* variable de détection d'appel SYSTICK */
+static volatile uint32_t _ticks;   /* nombre de ticks noyau écoulés         */
+
+static void file_att_insere(FILE_ATTENTE *f, uint16_t t);
 
 /*----------------------------------------------------------------------------*
  * fonctions du noyau                                                         *
@@ -47,6 +50,8 @@ uint8_t _timer_event = 0;          /* variable de détection d'appel SYSTICK */
     uint16_t j;
     /* Q2.1 : desactivation des interruptions */
     _irq_disable_();                       
+    /* la console ne sera plus videe par sa tache : retour a l'ecriture directe */
+    console_direct();
     
     /* affichage du nombre d'activation de chaque tache !*/
     printf("Sortie du noyau\n");
@@ -152,6 +157,12 @@ uint8_t _timer_event = 0;          /* variable de détection d'appel SYSTICK */
     p->arg = arg;
     /* initialisation du compteur de délai à zéro */
     p->delay = 0;
+    p->file_att = 0;
+    p->notif = 0;
+    p->notif_recue = 0;
+    file_att_init(&p->notif_file);
+    /* priorite courante : celle de creation, tant qu'aucun heritage */
+    p->prio = p->prio_base = prio;
     /* Q2.20 : mise a jour de l'etat de la tache a CREE */
     p->status = CREE; 
     /* Q2.21 : fin section critique */
@@ -218,6 +229,7 @@ uint32_t task_switch(uint32_t sp)
     p->sp = sp;      
 
     if (_timer_event) {
+    	_ticks++;
     	delay_process();
     	sep = '|';
     } else {
@@ -288,6 +300,20 @@ void schedule(void)
     pendsv_trigger();
 }
 
+/*
+ * demande de commutation en fin d'interruption
+ * entre  : 1 si la routine a reveille au moins une tache
+ * sortie : sans
+ * description : une seule demande de PendSV pour tous les reveils de la
+ *               routine ; la commutation a lieu au retour d'interruption
+ */
+void schedule_isr(uint8_t reveil)
+{
+	if (reveil) {
+		pendsv_trigger();
+	}
+}
+
 
 
 /*-------------------------------------------------------------------------*
@@ -349,3 +375,183 @@ uint16_t 	noyau_get_tc(void){
 NOYAU_TCB* 	noyau_get_p_tcb(uint16_t tcb_nb){
 	return &_noyau_tcb[tcb_nb];
 }
+
+/*
+ * change la priorite courante d'une tache
+ * entre  : numero de la tache, nouvelle priorite courante
+ * sortie : sans
+ * description : si la tache est eligible, elle passe dans la file de sa
+ *               nouvelle priorite ; si elle attend un objet, elle reprend
+ *               son rang dans la file d'attente. Aucune commutation n'est provoquee :
+ *               l'appelant appelle schedule() si necessaire.
+ *               A appeler en section critique.
+ */
+void noyau_change_prio(uint16_t t, uint8_t prio) {
+    NOYAU_TCB *p = &_noyau_tcb[t];
+
+    if (p->prio == prio) {
+        return;
+    }
+    if (p->status == PRET || p->status == EXEC) {
+        file_retire(t);
+        p->prio = prio;
+        file_ajoute(t);
+    } else if (p->file_att != 0) {
+        /* en attente sur un objet : reprend son rang dans la file */
+        file_att_retire(p->file_att, t);
+        p->prio = prio;
+        file_att_insere(p->file_att, t);
+    } else {
+        p->prio = prio;
+    }
+}
+
+/*
+ * recupere la date courante du noyau
+ * entre  : sans
+ * sortie : nombre de ticks systick depuis le demarrage
+ * description : le compteur est incremente a chaque evenement timer traite
+ *               par task_switch
+ */
+uint32_t 	noyau_get_ticks(void){
+	return(_ticks);
+}
+
+/*-------------------------------------------------------------------------*
+ *              --- Files d'attente des objets du noyau ---                *
+ * Les taches en attente sont chainees par le champ suivant_att de leur    *
+ * TCB, de la plus prioritaire a la moins prioritaire (priorite courante), *
+ * dans l'ordre d'arrivee a priorite egale. A manipuler en section         *
+ * critique.                                                               *
+ *-------------------------------------------------------------------------*/
+void file_att_init(FILE_ATTENTE *f) {
+    f->tete = ATT_FIN;
+    f->nb = 0;
+    f->expire = 0;
+}
+
+/* insere t derriere les taches de priorite superieure ou egale */
+static void file_att_insere(FILE_ATTENTE *f, uint16_t t) {
+    register uint8_t *k = &f->tete;
+    register uint8_t prio = _noyau_tcb[t].prio;
+
+    while (*k != ATT_FIN && _noyau_tcb[*k].prio <= prio) {
+        k = &_noyau_tcb[*k].suivant_att;
+    }
+    _noyau_tcb[t].suivant_att = *k;
+    *k = t;
+    f->nb++;
+}
+
+/* retire t de la file, sans effet s'il n'y est pas */
+void file_att_retire(FILE_ATTENTE *f, uint16_t t) {
+    register uint8_t *k = &f->tete;
+
+    while (*k != ATT_FIN) {
+        if (*k == t) {
+            *k = _noyau_tcb[t].suivant_att;
+            f->nb--;
+            return;
+        }
+        k = &_noyau_tcb[*k].suivant_att;
+    }
+}
+
+/* tache la plus prioritaire de la file, MAX_TACHES_NOYAU si elle est vide */
+uint16_t file_att_premier(FILE_ATTENTE *f) {
+    return (f->tete == ATT_FIN) ? MAX_TACHES_NOYAU : f->tete;
+}
+
+/*-------------------------------------------------------------------------*
+ *              --- Attente bornee sur un objet du noyau ---               *
+ * Entree : file d'attente de l'objet, delai maximal en ticks              *
+ *          (ATT_INFINI : pas de limite)                                   *
+ * Sortie : Neant                                                          *
+ * Descrip: Place la tache courante dans la file de l'objet et l'endort.   *
+ *          A appeler en section critique : la commutation a lieu a la     *
+ *          sortie de la section critique. Le resultat de l'attente est    *
+ *          ensuite lu par attente_etat() :                                *
+ *            ATT_OK      l'objet a ete attribue par attente_reveille      *
+ *            ATT_TIMEOUT le delai a expire, delay_process a retire la     *
+ *                        tache de la file                                 *
+ *            ATT_DETRUIT l'objet a ete detruit                            *
+ *-------------------------------------------------------------------------*/
+void attente(FILE_ATTENTE *f, uint32_t timeout) {
+    NOYAU_TCB *p = &_noyau_tcb[_tache_c];
+
+    file_att_insere(f, _tache_c);
+    p->file_att = f;
+    p->att_etat = ATT_OK;
+    p->delay = (timeout == ATT_INFINI) ? 0 : timeout;
+    dort();
+}
+
+/*-------------------------------------------------------------------------*
+ *              --- Fin d'attente sur un objet du noyau ---                *
+ * Entree : file d'attente de l'objet, resultat transmis a la tache        *
+ * Sortie : numero de la tache reveillee, MAX_TACHES_NOYAU si la file est  *
+ *          vide                                                           *
+ * Descrip: Retire la premiere tache de la file, annule son delai et la    *
+ *          rend eligible, sans provoquer de commutation : l'appelant      *
+ *          appelle schedule() une seule fois apres tous ses reveils.      *
+ *          A appeler en section critique.                                 *
+ *-------------------------------------------------------------------------*/
+uint16_t attente_reveille(FILE_ATTENTE *f, uint8_t etat) {
+    uint8_t t = f->tete;
+
+    if (t == ATT_FIN) {
+        return MAX_TACHES_NOYAU;
+    }
+    attente_termine(f, t, etat);
+    return t;
+}
+
+/*
+ * termine l'attente d'une tache quelconque de la file
+ * entre  : file d'attente de l'objet, tache en attente dans cette file,
+ *          resultat transmis a la tache
+ * sortie : sans
+ * description : comme attente_reveille, pour un objet qui choisit lui-meme
+ *               les taches a reveiller (drapeaux d'evenements)
+ */
+void attente_termine(FILE_ATTENTE *f, uint16_t t, uint8_t etat) {
+    NOYAU_TCB *p = &_noyau_tcb[t];
+
+    file_att_retire(f, t);
+    p->file_att = 0;
+    p->att_etat = etat;
+    p->delay = 0;
+    if (p->status == SUSP) {
+        p->status = EXEC;
+        file_ajoute(t);
+    }
+}
+
+/*
+ * deplace une tache en attente vers la file d'un autre objet
+ * entre  : file actuelle, nouvelle file, tache en attente dans la premiere
+ * sortie : sans
+ * description : la tache reste suspendue et prend son rang dans la
+ *               nouvelle file, sans limite de temps : son delai est annule
+ *               (variables de condition : le signal transfere la tache sur
+ *               la file du mutex sans la reveiller)
+ *               A appeler en section critique.
+ */
+void attente_deplace(FILE_ATTENTE *de, FILE_ATTENTE *vers, uint16_t t) {
+    NOYAU_TCB *p = &_noyau_tcb[t];
+
+    file_att_retire(de, t);
+    file_att_insere(vers, t);
+    p->file_att = vers;
+    p->att_etat = ATT_OK;
+    p->delay = 0;
+}
+
+/*
+ * recupere le resultat de la derniere attente de la tache courante
+ * entre  : sans
+ * sortie : ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT
+ */
+uint8_t attente_etat(void) {
+    return _noyau_tcb[_tache_c].att_etat;
+}
@@ -81,12 +81,38 @@ typedef struct __attribute__((packed, aligned(4))) {
 #define SUSP    0xA000    /* Etat suspendu          */
 #define EXEC    0xC000    /* Etat execution         */
 
+/* Resultat des attentes sur un objet du noyau */
+/***********************************************/
+
+#define ATT_OK       0    /* objet obtenu                          */
+#define ATT_TIMEOUT  1    /* delai expire avant d'obtenir l'objet  */
+#define ATT_DETRUIT  2    /* objet detruit pendant l'attente       */
+
+#define ATT_INFINI   0xffffffff  /* delai d'attente sans limite    */
+
+#define ATT_FIN      0xff        /* fin de file d'attente          */
+
 /* Definition des types */
 /************************/
 
 #define TACHE   void
 typedef TACHE   (*TACHE_ADR) (void *); /* pointeur de taches      */
 
+/* File d'attente d'un objet du noyau : liste chainee a travers les TCB
+ * (champ suivant_att), triee par priorite courante decroissante, dans
+ * l'ordre d'arrivee a priorite egale. Sa capacite n'est limitee que par le
+ * nombre de taches.
+ * expire, si l'objet le renseigne apres file_att_init, est appele par
+ * delay_process en section critique quand le delai d'une tache expire,
+ * juste apres son retrait de la file : l'objet met a jour son etat sans
+ * attendre que la tache s'execute de nouveau.
+ */
+typedef struct FILE_ATTENTE {
+  uint8_t   tete;           /* premiere tache, ATT_FIN si vide */
+  uint8_t   nb;             /* nombre de taches en attente     */
+  void      (*expire)(struct FILE_ATTENTE *f, uint16_t t);
+} FILE_ATTENTE;
+
 /* definition du contexte d'une tache */
 /**************************************/
 
@@ -98,6 +124,14 @@ typedef struct {
   TACHE_ADR task_adr;    	/* Pointeur de la fonction de tâche*/
   uint32_t  delay;			/* valeur courante decomptage pour reveil */
   void   	*arg; 			/* pointeur sur des paramètres supplémentaires pour la tâches */
+  FILE_ATTENTE *file_att;   /* file d'attente de l'objet attendu, 0 sinon */
+  uint8_t   suivant_att;    /* tache suivante dans file_att            */
+  uint8_t   prio_base;      /* priorite de creation de la tache       */
+  uint8_t   prio;           /* priorite courante, relevee par heritage */
+  uint8_t   att_etat;       /* resultat de la derniere attente (ATT_xxx) */
+  uint32_t  notif;          /* mot de notification (notify.h)          */
+  uint8_t   notif_recue;    /* 1 si une notification n'a pas ete lue   */
+  FILE_ATTENTE notif_file;  /* la tache elle-meme quand elle attend    */
 } NOYAU_TCB;
 
 
@@ -111,11 +145,26 @@ uint16_t 	cree(TACHE_ADR adr_tache, uint16_t id, void* add);
 void      	active      ( uint16_t tache );
 void      	schedule    ( void );
 void      	scheduler    ( void );
+void      	schedule_isr ( uint8_t reveil );
 void      	start       ( TACHE_ADR adr_tache );
 void      	dort        ( void );
 void      	reveille    ( uint16_t tache );
 uint16_t 	noyau_get_tc(void);
 NOYAU_TCB* 	noyau_get_p_tcb(uint16_t tcb_nb);
+uint32_t 	noyau_get_ticks(void);
+void      	noyau_change_prio(uint16_t t, uint8_t prio);
+
+/* Files d'attente des objets, a manipuler en section critique */
+void      	file_att_init( FILE_ATTENTE *f );
+void      	file_att_retire( FILE_ATTENTE *f, uint16_t t );
+uint16_t  	file_att_premier( FILE_ATTENTE *f );
+
+/* Attente bornee sur la file d'un objet, a appeler en section critique */
+void      	attente     ( FILE_ATTENTE *f, uint32_t timeout );
+uint16_t  	attente_reveille ( FILE_ATTENTE *f, uint8_t etat );
+void      	attente_termine ( FILE_ATTENTE *f, uint16_t t, uint8_t etat );
+void      	attente_deplace ( FILE_ATTENTE *de, FILE_ATTENTE *vers, uint16_t t );
+uint8_t   	attente_etat( void );
 
 #endif
 
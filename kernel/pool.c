@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------*
+ * fichier : pool.c                                                           *
+ * reserves de blocs de taille fixe pour le mini-noyau temps reel             *
+ *----------------------------------------------------------------------------*/
+
+#include "pool.h"
+
+#include "noyau_file_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * retire le premier bloc libre
+ * appelee en section critique
+ */
+static void *pool_retire(POOL *p) {
+	void *b = p->libres;
+
+	if (b) {
+		p->libres = *(void **) b;
+		if (--p->nb_libres < p->min_libres) {
+			p->min_libres = p->nb_libres;
+		}
+	}
+	return b;
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void pool_init(POOL *p, void *stockage, uint16_t taille, uint16_t nb) {
+	uint16_t i;
+	uint8_t *b;
+
+	if (taille < sizeof(void *)) {
+		taille = sizeof(void *);
+	}
+	p->stockage = stockage;
+	p->taille = POOL_TAILLE_BLOC(taille);
+	p->nb = nb;
+	p->nb_libres = nb;
+	p->min_libres = nb;
+	file_att_init(&p->attente);
+
+	/* chainage des blocs dans l'ordre de la zone */
+	p->libres = 0;
+	for (i = nb, b = p->stockage + nb * p->taille; i > 0; i--) {
+		b -= p->taille;
+		*(void **) b = p->libres;
+		p->libres = b;
+	}
+}
+
+void *pool_alloc(POOL *p) {
+	void *b;
+
+	_lock_();
+	b = pool_retire(p);
+	_unlock_();
+	return b;
+}
+
+/*
+ * alloue un bloc en attendant au plus timeout ticks
+ * description : la tache reveillee par pool_free reverifie la reserve ; une
+ *               tache plus prioritaire a pu prendre le bloc entre temps
+ */
+void *pool_alloc_timeout(POOL *p, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	int32_t reste;
+	void *b;
+
+	_lock_();
+	while ((b = pool_retire(p)) == 0 && timeout) {
+		if (timeout != ATT_INFINI) {
+			reste = (int32_t) (echeance - noyau_get_ticks());
+			if (reste <= 0) {
+				break;
+			}
+			attente(&p->attente, reste);
+		} else {
+			attente(&p->attente, ATT_INFINI);
+		}
+		_unlock_();		/* commutation, reprise au reveil */
+		_lock_();
+		if (attente_etat() != ATT_OK) {
+			b = pool_retire(p);
+			break;
+		}
+	}
+	_unlock_();
+	return b;
+}
+
+void pool_free(POOL *p, void *bloc) {
+	_lock_();
+	*(void **) bloc = p->libres;
+	p->libres = bloc;
+	p->nb_libres++;
+	if (attente_reveille(&p->attente, ATT_OK) != MAX_TACHES_NOYAU) {
+		schedule();
+	}
+	_unlock_();
+}
+
+uint16_t pool_libres(POOL *p) {
+	return p->nb_libres;
+}
+
+uint16_t pool_max_utilises(POOL *p) {
+	return p->nb - p->min_libres;
+}
+
+uint16_t pool_index(POOL *p, void *bloc) {
+	return ((uint8_t *) bloc - p->stockage) / p->taille;
+}
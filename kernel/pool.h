@@ -0,0 +1,76 @@
+/*----------------------------------------------------------------------------*
+ * fichier : pool.h                                                           *
+ * reserves de blocs de taille fixe pour le mini-noyau temps reel             *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant une reserve
+ * les blocs libres sont chaines par leur premier mot : allocation et
+ * liberation en temps constant, sans surcout par bloc
+ */
+typedef struct {
+    uint8_t *stockage;          // zone de nb * taille octets
+    void *libres;               // premier bloc libre, 0 si la reserve est vide
+    uint16_t taille;            // taille d'un bloc, arrondie au mot
+    uint16_t nb;                // nombre de blocs
+    uint16_t nb_libres;         // blocs libres
+    uint16_t min_libres;        // plus petit nombre de blocs libres atteint
+    FILE_ATTENTE attente;       // taches en attente d'un bloc
+} POOL;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * taille de la zone de stockage d'une reserve de nb blocs de taille octets
+ */
+#define POOL_TAILLE_BLOC(taille)   (((taille) + 3) & ~3)
+#define POOL_STOCKAGE(taille, nb)  (POOL_TAILLE_BLOC(taille) * (nb))
+
+/*
+ * initialise une reserve
+ * entre  : reserve, zone de POOL_STOCKAGE(taille, nb) octets alignee sur
+ *          un mot, taille d'un bloc (au moins un pointeur), nombre de blocs
+ */
+void pool_init(POOL *p, void *stockage, uint16_t taille, uint16_t nb);
+
+/*
+ * pool_alloc retourne un bloc, 0 si la reserve est vide ; elle ne bloque
+ * jamais et peut etre appelee en interruption
+ * pool_alloc_timeout attend un bloc au plus timeout ticks (ATT_INFINI :
+ * pas de limite) et retourne 0 si le delai expire
+ */
+void *pool_alloc(POOL *p);
+void *pool_alloc_timeout(POOL *p, uint32_t timeout);
+
+/*
+ * rend un bloc a la reserve et reveille la tache en attente la plus
+ * prioritaire ; peut etre appelee en interruption
+ */
+void pool_free(POOL *p, void *bloc);
+
+/*
+ * statistiques : blocs libres, et plus grand nombre de blocs utilises en
+ * meme temps depuis l'initialisation
+ */
+uint16_t pool_libres(POOL *p);
+uint16_t pool_max_utilises(POOL *p);
+
+/*
+ * numero d'un bloc de la reserve, de 0 a nb - 1
+ */
+uint16_t pool_index(POOL *p, void *bloc);
+
+#endif
@@ -0,0 +1,202 @@
+/*----------------------------------------------------------------------------*
+ * fichier : queue.c                                                          *
+ * files de messages pour le mini-noyau temps reel                            *
+ *----------------------------------------------------------------------------*/
+
+#include "queue.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "ensemble.h"
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * copie d'un element, par mots quand la taille et les adresses le permettent
+ * (cas du mode pointeur)
+ */
+static void q_copie(void *d, const void *s, uint16_t n) {
+	if (((n | (uint32_t) d | (uint32_t) s) & 3) == 0) {
+		register uint32_t *dw = d;
+		register const uint32_t *sw = s;
+		for (n >>= 2; n; n--) {
+			*dw++ = *sw++;
+		}
+	} else {
+		register uint8_t *db = d;
+		register const uint8_t *sb = s;
+		while (n--) {
+			*db++ = *sb++;
+		}
+	}
+}
+
+/*
+ * range un element en fin de file et reveille le recepteur le plus prioritaire
+ * appelee en section critique, la file n'est pas pleine
+ */
+static void q_ecrit(QUEUE *q, const void *elem) {
+	uint16_t i = q->tete + q->nb;
+
+	if (i >= q->profondeur) {
+		i -= q->profondeur;
+	}
+	q_copie(q->stockage + i * q->taille, elem, q->taille);
+	q->nb++;
+	if (attente_reveille(&q->recepteurs, ATT_OK) != MAX_TACHES_NOYAU
+			|| (q->ensemble != NULL && ens_signale(q->ensemble))) {
+		schedule();
+	}
+}
+
+/*
+ * retire l'element de tete et reveille l'emetteur en attente le plus
+ * prioritaire
+ * appelee en section critique, la file n'est pas vide
+ */
+static void q_lit(QUEUE *q, void *elem) {
+	q_copie(elem, q->stockage + q->tete * q->taille, q->taille);
+	if (++q->tete == q->profondeur) {
+		q->tete = 0;
+	}
+	q->nb--;
+	if (attente_reveille(&q->emetteurs, ATT_OK) != MAX_TACHES_NOYAU) {
+		schedule();
+	}
+}
+
+/*
+ * attend une place (ou un element) dans la file, au plus jusqu'a l'echeance
+ * appelee en section critique ; la section critique est relachee pendant
+ * l'attente. Le reveil ne garantit pas que la condition soit vraie (une
+ * tache plus prioritaire a pu passer avant), l'appelant reverifie.
+ * sortie : ATT_OK pour reverifier, ATT_TIMEOUT ou ATT_DETRUIT pour abandonner
+ */
+static uint8_t q_attend(FILE_ATTENTE *f, uint32_t timeout, uint32_t echeance) {
+	int32_t reste;
+
+	if (timeout != ATT_INFINI) {
+		reste = (int32_t) (echeance - noyau_get_ticks());
+		if (reste <= 0) {
+			return ATT_TIMEOUT;
+		}
+		timeout = reste;
+	}
+	attente(f, timeout);
+	_unlock_();		/* commutation, reprise au reveil */
+	_lock_();
+	return attente_etat();
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void q_init(QUEUE *q, void *stockage, uint16_t taille, uint16_t profondeur) {
+	q->stockage = stockage;
+	q->taille = taille;
+	q->profondeur = profondeur;
+	q->tete = 0;
+	q->nb = 0;
+	file_att_init(&q->emetteurs);
+	file_att_init(&q->recepteurs);
+	q->ensemble = NULL;
+}
+
+/*
+ * envoie un element
+ * entre  : file, adresse de l'element a copier,
+ *          delai d'attente maximal en ticks (0 : pas d'attente,
+ *          ATT_INFINI : pas de limite)
+ * sortie : ATT_OK si l'element est place, ATT_TIMEOUT sinon
+ * description : si la file est pleine, la tache est suspendue jusqu'a ce
+ *               qu'un recepteur libere une place ou que le delai expire
+ */
+uint8_t q_send_timeout(QUEUE *q, const void *elem, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint8_t etat = ATT_OK;
+
+	_lock_();
+	while (q->nb == q->profondeur && etat == ATT_OK) {
+		etat = q_attend(&q->emetteurs, timeout, echeance);
+	}
+	if (etat == ATT_OK) {
+		q_ecrit(q, elem);
+	}
+	_unlock_();
+	return etat;
+}
+
+void q_send(QUEUE *q, const void *elem) {
+	q_send_timeout(q, elem, ATT_INFINI);
+}
+
+int q_try_send(QUEUE *q, const void *elem) {
+	int ok = 0;
+
+	_lock_();
+	if (q->nb < q->profondeur) {
+		q_ecrit(q, elem);
+		ok = 1;
+	}
+	_unlock_();
+	return ok;
+}
+
+/*
+ * recoit un element
+ * entre  : file, adresse ou copier l'element,
+ *          delai d'attente maximal en ticks (0 : pas d'attente,
+ *          ATT_INFINI : pas de limite)
+ * sortie : ATT_OK si un element a ete lu, ATT_TIMEOUT sinon
+ * description : si la file est vide, la tache est suspendue jusqu'a ce
+ *               qu'un emetteur depose un element ou que le delai expire
+ */
+uint8_t q_receive_timeout(QUEUE *q, void *elem, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint8_t etat = ATT_OK;
+
+	_lock_();
+	while (q->nb == 0 && etat == ATT_OK) {
+		etat = q_attend(&q->recepteurs, timeout, echeance);
+	}
+	if (etat == ATT_OK) {
+		q_lit(q, elem);
+	}
+	_unlock_();
+	return etat;
+}
+
+void q_receive(QUEUE *q, void *elem) {
+	q_receive_timeout(q, elem, ATT_INFINI);
+}
+
+int q_try_receive(QUEUE *q, void *elem) {
+	int ok = 0;
+
+	_lock_();
+	if (q->nb) {
+		q_lit(q, elem);
+		ok = 1;
+	}
+	_unlock_();
+	return ok;
+}
+
+void q_send_ptr(QUEUE *q, void *p) {
+	q_send(q, &p);
+}
+
+int q_try_send_ptr(QUEUE *q, void *p) {
+	return q_try_send(q, &p);
+}
+
+void *q_receive_ptr(QUEUE *q) {
+	void *p;
+
+	q_receive(q, &p);
+	return p;
+}
@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------*
+ * fichier : queue.h                                                          *
+ * files de messages pour le mini-noyau temps reel                            *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __QUEUE_H__
+#define __QUEUE_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+struct ENSEMBLE;
+
+/*
+ * structure definissant une file de messages
+ * le stockage des elements (profondeur * taille octets) est fourni par
+ * l'application, la structure peut donc etre allouee statiquement
+ */
+typedef struct {
+    uint8_t *stockage;      // zone de stockage des elements
+    uint16_t taille;        // taille d'un element en octets
+    uint16_t profondeur;    // nombre maximal d'elements
+    uint16_t tete;          // index du prochain element a lire
+    uint16_t nb;            // nombre d'elements presents
+    FILE_ATTENTE emetteurs;     // taches en attente de place
+    FILE_ATTENTE recepteurs;    // taches en attente d'un element
+    struct ENSEMBLE *ensemble;  // ensemble d'attente (ensemble.h), NULL sinon
+} QUEUE;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise une file de messages
+ * entre  : file, zone de stockage de profondeur * taille octets,
+ *          taille d'un element, nombre d'elements
+ * sortie : sans
+ */
+void q_init(QUEUE *q, void *stockage, uint16_t taille, uint16_t profondeur);
+
+/*
+ * envoie un element (copie de taille octets)
+ * q_send suspend la tache tant que la file est pleine
+ * q_send_timeout attend au plus timeout ticks et retourne ATT_OK ou
+ * ATT_TIMEOUT
+ * q_try_send retourne 1 si l'element a ete place, 0 si la file est pleine ;
+ * elle ne bloque jamais et peut etre appelee en interruption
+ */
+void q_send(QUEUE *q, const void *elem);
+uint8_t q_send_timeout(QUEUE *q, const void *elem, uint32_t timeout);
+int q_try_send(QUEUE *q, const void *elem);
+
+/*
+ * recoit l'element le plus ancien
+ * q_receive suspend la tache tant que la file est vide
+ * q_receive_timeout attend au plus timeout ticks et retourne ATT_OK ou
+ * ATT_TIMEOUT
+ * q_try_receive retourne 1 si un element a ete lu, 0 si la file est vide
+ */
+void q_receive(QUEUE *q, void *elem);
+uint8_t q_receive_timeout(QUEUE *q, void *elem, uint32_t timeout);
+int q_try_receive(QUEUE *q, void *elem);
+
+/*
+ * mode pointeur : la file transporte des pointeurs (taille sizeof(void *))
+ * un tampon passe ainsi d'une tache a l'autre sans etre copie ; il
+ * appartient au recepteur jusqu'a ce qu'il le rende
+ */
+void q_send_ptr(QUEUE *q, void *p);
+int q_try_send_ptr(QUEUE *q, void *p);
+void *q_receive_ptr(QUEUE *q);
+
+#endif
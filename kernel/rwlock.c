@@ -0,0 +1,377 @@
+/*----------------------------------------------------------------------------*
+ * fichier : rwlock.c                                                         *
+ * verrous lecteurs/ecrivain pour le mini-noyau temps reel                    *
+ *----------------------------------------------------------------------------*/
+
+#include "rwlock.h"
+
+#include "mutex.h"
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------*
+ * variables globales internes                                                *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * verrous initialises, parcourus pour recalculer la priorite heritee
+ */
+static RWLOCK *_rw_liste;
+
+/*
+ * nombre de verrous detenus par chaque tache : le parcours de _rw_liste
+ * n'a lieu que pour une tache qui en detient au moins un
+ */
+static uint8_t _rw_detenus[MAX_TACHES_NOYAU];
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+#define RW_PRIO(t)     (noyau_get_p_tcb(t)->prio)
+#define RW_BIT(t)      ((uint64_t) 1 << (t))
+
+/*
+ * teste si t detient le verrou, en lecture ou en ecriture
+ */
+static int rw_detient(RWLOCK *rw, uint16_t t) {
+	return rw->ecrivain == t + 1 || (rw->detenteurs & RW_BIT(t));
+}
+
+/*
+ * arbitre entre l'ecrivain en attente w et le lecteur r (en attente ou
+ * demandeur, MAX_TACHES_NOYAU si aucun) selon la politique du verrou
+ * sortie : 1 si l'ecrivain passe avant le lecteur
+ */
+static int rw_ecrivain_passe(RWLOCK *rw, uint16_t w, uint16_t r) {
+	if (r == MAX_TACHES_NOYAU) {
+		return 1;
+	}
+	switch (rw->politique) {
+	case RW_LECTEUR:
+		return 0;
+	case RW_PRIORITE:
+		return RW_PRIO(w) <= RW_PRIO(r);
+	default:
+		return 1;
+	}
+}
+
+/*
+ * teste si le lecteur r peut entrer maintenant
+ */
+static int rw_lecteur_admis(RWLOCK *rw, uint16_t r) {
+	uint16_t w = file_att_premier(&rw->ecrivains);
+
+	return !rw->ecrivain && (w == MAX_TACHES_NOYAU || !rw_ecrivain_passe(rw, w, r));
+}
+
+static void rw_ajoute_lecteur(RWLOCK *rw, uint16_t r) {
+	rw->detenteurs |= RW_BIT(r);
+	rw->nb_lecteurs++;
+	_rw_detenus[r]++;
+}
+
+/*
+ * releve a prio l'ecrivain ou chacun des lecteurs presents
+ */
+static void rw_herite(RWLOCK *rw, uint8_t prio) {
+	uint64_t d = rw->detenteurs;
+
+	if (rw->ecrivain) {
+		m_herite(rw->ecrivain - 1, prio);
+	}
+	while (d) {
+		m_herite(__builtin_ctzll(d), prio);
+		d &= d - 1;
+	}
+}
+
+/*
+ * recalcule la priorite des taches presentes apres le depart d'une tache
+ * en attente
+ */
+static void rw_recalcule(RWLOCK *rw) {
+	uint64_t d = rw->detenteurs;
+
+	if (rw->ecrivain) {
+		m_recalcule(rw->ecrivain - 1);
+	}
+	while (d) {
+		m_recalcule(__builtin_ctzll(d));
+		d &= d - 1;
+	}
+}
+
+/*
+ * attribue le verrou aux taches en attente qui peuvent l'obtenir : un
+ * ecrivain si le verrou est libre et que la politique le fait passer,
+ * sinon tous les lecteurs admis, en une seule passe
+ * sortie : nombre de taches reveillees
+ * appelee en section critique, sans commutation
+ */
+static uint32_t rw_transmet(RWLOCK *rw) {
+	uint16_t w = file_att_premier(&rw->ecrivains);
+	uint16_t r = file_att_premier(&rw->lecteurs);
+	uint32_t reveils = 0;
+
+	if (rw->ecrivain) {
+		return 0;
+	}
+	if (w != MAX_TACHES_NOYAU && rw_ecrivain_passe(rw, w, r)) {
+		if (rw->nb_lecteurs) {
+			return 0;       // l'ecrivain attend le depart des lecteurs
+		}
+		attente_reveille(&rw->ecrivains, ATT_OK);
+		rw->ecrivain = w + 1;
+		_rw_detenus[w]++;
+		// herite des lecteurs qui attendent encore
+		m_recalcule(w);
+		return 1;
+	}
+	// la file est triee : les lecteurs admis sont en tete
+	while (r != MAX_TACHES_NOYAU && rw_lecteur_admis(rw, r)) {
+		attente_reveille(&rw->lecteurs, ATT_OK);
+		rw_ajoute_lecteur(rw, r);
+		reveils++;
+		r = file_att_premier(&rw->lecteurs);
+	}
+	if (reveils && w != MAX_TACHES_NOYAU) {
+		// un ecrivain attend les nouveaux lecteurs
+		rw_herite(rw, RW_PRIO(w));
+	}
+	return reveils;
+}
+
+/*
+ * expiration du delai d'une tache en attente, appelee par delay_process
+ * apres son retrait de la file : un ecrivain qui abandonne peut debloquer
+ * les lecteurs qu'il retenait, et les taches presentes n'heritent plus de
+ * sa priorite
+ */
+static void rw_expire(RWLOCK *rw) {
+	rw_transmet(rw);
+	rw_recalcule(rw);
+}
+
+static void rw_expire_lecteur(FILE_ATTENTE *f, uint16_t t) {
+	(void) t;
+	rw_expire((RWLOCK *) ((uint8_t *) f - offsetof(RWLOCK, lecteurs)));
+}
+
+static void rw_expire_ecrivain(FILE_ATTENTE *f, uint16_t t) {
+	(void) t;
+	rw_expire((RWLOCK *) ((uint8_t *) f - offsetof(RWLOCK, ecrivains)));
+}
+
+/*
+ * met la tache courante en attente dans f
+ * appelee en section critique, la relache
+ */
+static uint8_t rw_attend(RWLOCK *rw, FILE_ATTENTE *f, uint16_t tc, uint32_t timeout) {
+	rw_herite(rw, RW_PRIO(tc));
+	attente(f, timeout);
+	_unlock_();
+
+	return attente_etat();
+}
+
+/*
+ * arrete le noyau si la tache courante detient deja le verrou
+ */
+static void rw_verifie_libre(RWLOCK *rw, uint16_t tc) {
+	if (rw_detient(rw, tc)) {
+		printf("Tache %d : verrou lecteurs/ecrivain deja detenu\n", tc);
+		noyau_exit();
+	}
+}
+
+/*
+ * fin de detention par tc : restitue sa priorite si elle a herite, puis
+ * attribue le verrou aux taches en attente
+ */
+static void rw_quitte(RWLOCK *rw, uint16_t tc) {
+	register NOYAU_TCB *p = noyau_get_p_tcb(tc);
+	uint8_t commute = 0;
+
+	_rw_detenus[tc]--;
+	if (p->prio != p->prio_base) {
+		m_recalcule(tc);
+		commute = 1;
+	}
+	if (rw_transmet(rw)) {
+		commute = 1;
+	}
+	if (commute) {
+		schedule();
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un verrou lecteurs/ecrivain
+ * entre  : verrou, politique (RW_ECRIVAIN, RW_LECTEUR, RW_PRIORITE)
+ * sortie : sans
+ */
+void rw_init(RWLOCK *rw, uint8_t politique) {
+	file_att_init(&rw->lecteurs);
+	file_att_init(&rw->ecrivains);
+	rw->lecteurs.expire = rw_expire_lecteur;
+	rw->ecrivains.expire = rw_expire_ecrivain;
+	rw->detenteurs = 0;
+	rw->nb_lecteurs = 0;
+	rw->ecrivain = 0;
+	rw->politique = politique;
+	_lock_();
+	rw->suivant = _rw_liste;
+	_rw_liste = rw;
+	_unlock_();
+}
+
+/*
+ * detruit un verrou
+ * entre  : verrou, qui ne doit plus etre detenu
+ * sortie : sans
+ * description : les taches en attente terminent par ATT_DETRUIT
+ */
+void rw_detruit(RWLOCK *rw) {
+	register RWLOCK **k = &_rw_liste;
+
+	_lock_();
+	if (rw->ecrivain || rw->nb_lecteurs) {
+		printf("Le verrou lecteurs/ecrivain est encore detenu\n");
+		noyau_exit();
+	}
+	while (attente_reveille(&rw->lecteurs, ATT_DETRUIT) != MAX_TACHES_NOYAU)
+		continue;
+	while (attente_reveille(&rw->ecrivains, ATT_DETRUIT) != MAX_TACHES_NOYAU)
+		continue;
+	while (*k != rw) {
+		k = &(*k)->suivant;
+	}
+	*k = rw->suivant;
+	schedule();
+	_unlock_();
+}
+
+/*
+ * prend le verrou en lecture
+ * entre  : verrou, delai d'attente maximal en ticks
+ * sortie : ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT
+ * description : entre immediatement si aucun ecrivain n'est present et si
+ *               la politique ne donne pas la main a un ecrivain en attente
+ */
+uint8_t rw_lecture(RWLOCK *rw, uint32_t timeout) {
+	uint16_t tc = noyau_get_tc();
+
+	_lock_();
+	rw_verifie_libre(rw, tc);
+	if (rw_lecteur_admis(rw, tc)) {
+		rw_ajoute_lecteur(rw, tc);
+		_unlock_();
+		return ATT_OK;
+	}
+	if (timeout == 0) {
+		_unlock_();
+		return ATT_TIMEOUT;
+	}
+	// rw_transmet nous ajoutera aux lecteurs
+	return rw_attend(rw, &rw->lecteurs, tc, timeout);
+}
+
+/*
+ * rend le verrou pris en lecture
+ * description : le dernier lecteur laisse entrer l'ecrivain en attente
+ */
+void rw_lecture_fin(RWLOCK *rw) {
+	uint16_t tc = noyau_get_tc();
+
+	_lock_();
+	if (!(rw->detenteurs & RW_BIT(tc))) {
+		printf("Tache %d : verrou non detenu en lecture\n", tc);
+		noyau_exit();
+	}
+	rw->detenteurs &= ~RW_BIT(tc);
+	rw->nb_lecteurs--;
+	rw_quitte(rw, tc);
+	_unlock_();
+}
+
+/*
+ * prend le verrou en ecriture
+ * entre  : verrou, delai d'attente maximal en ticks
+ * sortie : ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT
+ * description : entre immediatement si le verrou est libre ; sinon
+ *               l'ecrivain attend, et selon la politique les nouveaux
+ *               lecteurs attendent derriere lui
+ */
+uint8_t rw_ecriture(RWLOCK *rw, uint32_t timeout) {
+	uint16_t tc = noyau_get_tc();
+
+	_lock_();
+	rw_verifie_libre(rw, tc);
+	if (!rw->ecrivain && rw->nb_lecteurs == 0) {
+		rw->ecrivain = tc + 1;
+		_rw_detenus[tc]++;
+		_unlock_();
+		return ATT_OK;
+	}
+	if (timeout == 0) {
+		_unlock_();
+		return ATT_TIMEOUT;
+	}
+	// rw_transmet nous attribuera le verrou
+	return rw_attend(rw, &rw->ecrivains, tc, timeout);
+}
+
+/*
+ * rend le verrou pris en ecriture
+ */
+void rw_ecriture_fin(RWLOCK *rw) {
+	uint16_t tc = noyau_get_tc();
+
+	_lock_();
+	if (rw->ecrivain != tc + 1) {
+		printf("Tache %d : verrou non detenu en ecriture\n", tc);
+		noyau_exit();
+	}
+	rw->ecrivain = 0;
+	rw_quitte(rw, tc);
+	_unlock_();
+}
+
+/*
+ * priorite heritee des verrous detenus
+ * entre  : tache, priorite deja calculee
+ * sortie : prio, relevee a celle de la tache la plus prioritaire en
+ *          attente sur l'un des verrous que t detient
+ * description : appelee par le recalcul de priorite des mutex, en section
+ *               critique
+ */
+uint8_t rw_prio_heritee(uint16_t t, uint8_t prio) {
+	register RWLOCK *rw;
+	uint16_t w;
+
+	if (_rw_detenus[t] == 0) {
+		return prio;
+	}
+	for (rw = _rw_liste; rw != NULL; rw = rw->suivant) {
+		if (!rw_detient(rw, t)) {
+			continue;
+		}
+		w = file_att_premier(&rw->ecrivains);
+		if (w != MAX_TACHES_NOYAU && RW_PRIO(w) < prio) {
+			prio = RW_PRIO(w);
+		}
+		w = file_att_premier(&rw->lecteurs);
+		if (w != MAX_TACHES_NOYAU && RW_PRIO(w) < prio) {
+			prio = RW_PRIO(w);
+		}
+	}
+	return prio;
+}
@@ -0,0 +1,77 @@
+/*----------------------------------------------------------------------------*
+ * fichier : rwlock.h                                                         *
+ * verrous lecteurs/ecrivain pour le mini-noyau temps reel                    *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __RWLOCK_H__
+#define __RWLOCK_H__
+
+#include <stdint.h>
+
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * politique d'arbitrage entre lecteurs et ecrivains en attente
+ */
+#define RW_ECRIVAIN    0   // un ecrivain en attente bloque les nouveaux lecteurs
+#define RW_LECTEUR     1   // les lecteurs entrent tant qu'aucun ecrivain ne detient le verrou
+#define RW_PRIORITE    2   // un lecteur n'entre que s'il est plus prioritaire que
+                           // l'ecrivain en attente le plus prioritaire
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant un verrou lecteurs/ecrivain, allouee par
+ * l'application ; les champs ne doivent pas etre modifies directement
+ */
+typedef struct RWLOCK {
+    FILE_ATTENTE lecteurs;      // lecteurs en attente, par priorite
+    FILE_ATTENTE ecrivains;     // ecrivains en attente, par priorite
+    uint64_t detenteurs;        // un bit par tache lectrice
+    struct RWLOCK *suivant;     // verrou initialise suivant
+    uint8_t nb_lecteurs;        // nombre de lecteurs presents
+    uint8_t ecrivain;           // ecrivain present + 1, 0 si aucun
+    uint8_t politique;          // RW_ECRIVAIN, RW_LECTEUR ou RW_PRIORITE
+} RWLOCK;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un verrou (une seule fois par objet) et le detruit ; les
+ * taches en attente lors de la destruction terminent par ATT_DETRUIT
+ */
+void rw_init(RWLOCK *rw, uint8_t politique);
+void rw_detruit(RWLOCK *rw);
+
+/*
+ * prend le verrou en lecture (partage) ou en ecriture (exclusif), au plus
+ * timeout ticks (0 : pas d'attente, ATT_INFINI : pas de limite)
+ * retourne ATT_OK, ATT_TIMEOUT ou ATT_DETRUIT
+ * le verrou n'est pas re-entrant : une tache qui le detient deja et le
+ * redemande arrete le noyau
+ *
+ * les taches en attente sont servies par priorite ; tant qu'une tache
+ * attend, l'ecrivain ou chacun des lecteurs presents s'execute au moins a
+ * sa priorite, comme pour un mutex MUTEX_HERITAGE (l'heritage se propage
+ * aux mutex que ces taches attendent)
+ */
+uint8_t rw_lecture(RWLOCK *rw, uint32_t timeout);
+void rw_lecture_fin(RWLOCK *rw);
+uint8_t rw_ecriture(RWLOCK *rw, uint32_t timeout);
+void rw_ecriture_fin(RWLOCK *rw);
+
+/*
+ * usage interne (mutex.c) : priorite prio relevee a celle des taches en
+ * attente sur les verrous detenus par t ; en section critique
+ */
+uint8_t rw_prio_heritee(uint16_t t, uint8_t prio);
+
+#endif
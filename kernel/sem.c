@@ -5,20 +5,20 @@
 
 #include "sem.h"
 
-#include "fifo.h"
 #include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "ensemble.h"
 #include <stdio.h>
-/*----------------------------------------------------------------------------*
- * declaration des structures                                                 *
- *----------------------------------------------------------------------------*/
 
 /*
- * structure definissant un semaphore
+ * un numero de semaphore code l'indice dans _sem (4 bits de poids faible)
+ * et la generation de l'entree (4 bits de poids fort). La generation
+ * change a chaque fermeture : un numero perime est detecte en temps
+ * constant. Elle ne prend que 15 valeurs, 0xff n'est donc jamais valide.
  */
-typedef struct {
-    FIFO file;
-    int8_t valeur;
-} SEMAPHORE;
+#define SEM_INDICE(n)       ((n) & 0x0f)
+#define SEM_GENERATION(n)   ((n) >> 4)
+#define SEM_GEN_NB          15
 
 /*----------------------------------------------------------------------------*
  * variables globales internes                                                *
@@ -29,120 +29,256 @@ typedef struct {
  */
 SEMAPHORE _sem[MAX_SEM];
 
+/*
+ * premiere entree libre de _sem, MAX_SEM si la table est pleine
+ */
+static uint8_t _sem_libre;
+
 /*----------------------------------------------------------------------------*
- * definition des fonctions                                                   *
+ * fonctions internes                                                         *
  *----------------------------------------------------------------------------*/
 
 /*
- * /!!!!\ NOTE IMPORTANTE /!!!!\
- * pour faire les verifications de file, on pourra utiliser la variable de
- * file fifo_taille et la mettre a -1 dans le cas ou la file n'est pas
- * utilisee
+ * retrouve le semaphore d'un numero, arrete le noyau s'il est invalide
+ */
+static SEMAPHORE *s_verifie(uint8_t n) {
+	register SEMAPHORE *s = &_sem[SEM_INDICE(n)];
+
+	if (!s->cree || s->generation != SEM_GENERATION(n))
+	{
+		printf("Ce sémaphore n'a pas déjà été créer");
+		noyau_exit();
+	}
+	return s;
+}
+
+/*
+ * transmet nb jetons : un a chacune des taches en attente, par ordre de
+ * priorite, le reste s'ajoute au compteur
+ * sortie : nombre de taches reveillees
+ * appelee en section critique, sans commutation
  */
+static uint32_t s_libere(SEMAPHORE *s, uint32_t nb) {
+	uint32_t reveils = 0;
+
+	while (nb && attente_reveille(&s->file, ATT_OK) != MAX_TACHES_NOYAU)
+	{
+		nb--;
+		reveils++;
+	}
+	s->valeur += nb;
+	if (s->valeur > 0 && s->ensemble != NULL)
+	{
+		reveils += ens_signale(s->ensemble);
+	}
+	return reveils;
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
 
 /*
  * initialise les sempaphore du systeme
  * entre  : sans
  * sortie : sans
- * description : initialise l'ensemble des semaphores du systeme
+ * description : initialise l'ensemble des semaphores du systeme et chaine
+ *               les entrees libres
  */
 void s_init(void) {
 	register SEMAPHORE *s = _sem;
 	register unsigned j;
-		   
-   
+
 	for (j = 0; j < MAX_SEM; j++)
 	{
-		s->file.fifo_taille = -1;
+		s->cree = 0;
+		s->generation = 0;
+		s->suivant_libre = j + 1;
 		s++;
 	}
+	_sem_libre = 0;
+}
+
+/*
+ * initialise un semaphore fourni par l'application
+ * entre  : semaphore, valeur initiale
+ * sortie : sans
+ * description : aucune table n'est parcourue ; le nombre de semaphores
+ *               n'est limite que par la memoire
+ */
+void s_init_static(SEMAPHORE *s, int32_t valeur) {
+	file_att_init(&s->file);
+	s->valeur = valeur;
+	s->ensemble = NULL;
+	s->cree = 1;
 }
 
 /*
  * cree un semaphore
  * entre  : valeur du semaphore a creer
  * sortie : numero du semaphore cree
- * description : cree un semaphore
+ * description : cree un semaphore en prenant la premiere entree de la
+ *               liste des entrees libres
  *               en cas d'erreur, le noyau doit etre arrete
  */
-uint8_t s_cree(int8_t valeur) {
-	register SEMAPHORE *s = _sem;
-	register unsigned n = 0;
+uint8_t s_cree(int32_t valeur) {
+	register SEMAPHORE *s;
+	uint8_t n;
 
 	_lock_();
-	/* Rechercher un sem libre */
-	while(s->file.fifo_taille != -1 && n < MAX_SEM)
-	{
-		n++;
-		s++;
-	}
-
-	if (n < MAX_SEM)
-	{
-		fifo_init(&(s->file));
-		s->valeur = valeur;
-	}
-	else
+	n = _sem_libre;
+	if (n == MAX_SEM)
 	{
 		printf("Tnetative de creer unn sémaphore qui a échouée");
 		noyau_exit();
 	}
+	s = &_sem[n];
+	_sem_libre = s->suivant_libre;
+	s_init_static(s, valeur);
 	_unlock_();
 
-	return(n);	   
+	return n | (s->generation << 4);
+}
+
+/*
+ * ferme un semaphore
+ * entre  : semaphore
+ * sortie : sans
+ * description : les taches en attente sont reveillees, leur attente se
+ *               termine par ATT_DETRUIT
+ */
+void s_close_p(SEMAPHORE *s) {
+	_lock_();
+	while (attente_reveille(&s->file, ATT_DETRUIT) != MAX_TACHES_NOYAU)
+		continue;
+	s->cree = 0;
+	schedule();
+	_unlock_();
 }
 
 /*
  * ferme un semaphore pour qu'il puisse etre reutilise
  * entre  : numero du semaphore a fermer
  * sortie : sans
- * description : ferme un semaphore
+ * description : ferme un semaphore et rend son entree a la liste des
+ *               entrees libres ; les anciens numeros deviennent invalides
  *               en cas d'erreur, le noyau doit etre arrete
  */
 void s_close(uint8_t n) {
-	register SEMAPHORE *s = &_sem[n];
+	register SEMAPHORE *s;
 
+	// une seule section critique : deux fermetures du meme numero ne
+	// peuvent pas rendre l'entree deux fois
 	_lock_();
+	s = s_verifie(n);
+	s_close_p(s);
+	s->generation = (s->generation + 1) % SEM_GEN_NB;
+	s->suivant_libre = _sem_libre;
+	_sem_libre = SEM_INDICE(n);
+	_unlock_();
+}
 
-	/* V‚rifier sem cr‚e */
-	if (s->file.fifo_taille == -1)
+/*
+ * prend le semaphore ou attend
+ * appelee en section critique (un seul niveau), la relache : la tache
+ * s'endort a la sortie de la section critique
+ */
+static uint8_t s_attend(SEMAPHORE *s, uint32_t timeout) {
+	if (!s->cree)
 	{
-		printf("Ce sémaphore n'a pas déjà été créer");
-		noyau_exit();
+		_unlock_();
+		return ATT_DETRUIT;
+	}
+	if (s->valeur > 0)
+	{
+		s->valeur--;
+		_unlock_();
+		return ATT_OK;
 	}
+	if (timeout == 0)
+	{
+		_unlock_();
+		return ATT_TIMEOUT;
+	}
+
+	/* le jeton sera transmis directement par s_signal */
+	attente(&s->file, timeout);
+	_unlock_();
 
-	s->file.fifo_taille = -1;
-	_unlock_();		   
+	return attente_etat();
 }
 
 /*
- * tente de prendre le semaphore dont le numero est passe en parametre
- * entre  : numero du semaphore a prendre
- * sortie : sans
- * description : prend le semaphore
- *               si echec, la tache doit etre suspendue
- *               en cas d'erreur, le noyau doit etre arrete
+ * arrete le noyau si un semaphore fourni par l'application a ete ferme
+ * appelee en section critique
  */
-void s_wait(uint8_t n) {
+static void s_verifie_p(SEMAPHORE *s) {
+	if (!s->cree)
+	{
+		printf("Signal sur un semaphore ferme");
+		noyau_exit();
+	}
+}
 
-	register SEMAPHORE *s = &_sem[n];
+/*
+ * tente de prendre le semaphore
+ * entre  : semaphore a prendre
+ *          delai d'attente maximal en ticks (0 : pas d'attente,
+ *          ATT_INFINI : pas de limite)
+ * sortie : ATT_OK si le semaphore est pris, ATT_TIMEOUT si le delai a
+ *          expire, ATT_DETRUIT si le semaphore a ete ferme
+ * description : prend le semaphore
+ *               si echec, la tache est suspendue au plus timeout ticks
+ */
+uint8_t s_wait_timeout_p(SEMAPHORE *s, uint32_t timeout) {
+	_lock_();
+	return s_attend(s, timeout);
+}
 
+/*
+ * par numero : le numero est verifie dans la meme section critique que
+ * l'operation, une entree fermee puis reattribuee entre les deux est donc
+ * refusee ; de meme pour les autres fonctions par numero
+ */
+uint8_t s_wait_timeout(uint8_t n, uint32_t timeout) {
 	_lock_();
+	return s_attend(s_verifie(n), timeout);
+}
 
-	if (s->file.fifo_taille == -1)
-	{
-		printf("Ce sémaphore n'a pas déjà été créer");
-		noyau_exit();
-	}
+/*
+ * prend le semaphore, sans limite de temps
+ */
+void s_wait_p(SEMAPHORE *s) {
+	s_wait_timeout_p(s, ATT_INFINI);
+}
 
-	s->valeur--;
-	if (s->valeur < 0)
+void s_wait(uint8_t n) {
+	s_wait_timeout(n, ATT_INFINI);
+}
+
+/*
+ * libere nb jetons d'un coup
+ * entre  : semaphore, nombre de jetons
+ * sortie : sans
+ * description : si des taches sont en attentes, les jetons sont transmis
+ *               aux plus prioritaires, qui sont reveillees ; le reste
+ *               s'ajoute au compteur. Une seule section critique et une
+ *               seule demande de commutation.
+ */
+void s_signal_n_p(SEMAPHORE *s, uint32_t nb) {
+	_lock_();
+	s_verifie_p(s);
+	if (s_libere(s, nb))
 	{
-		fifo_ajoute(&s->file, noyau_get_tc());
-		dort();
+		schedule();
 	}
+	_unlock_();
+}
 
-	_unlock_();		
+void s_signal_n(uint8_t n, uint32_t nb) {
+	_lock_();
+	s_signal_n_p(s_verifie(n), nb);
+	_unlock_();
 }
 
 /*
@@ -150,32 +286,39 @@ void s_wait(uint8_t n) {
  * entre  : numero du semaphore a liberer
  * sortie : sans
  * description : libere un semaphore
- *               si des taches sont en attentes, la premiere doit etre reveillee
+ *               si des taches sont en attentes, le jeton est transmis a la
+ *               plus prioritaire, qui est reveillee ; sinon le compteur augmente
  *               en cas d'erreur, le noyau doit etre arrete
  */
+void s_signal_p(SEMAPHORE *s) {
+	s_signal_n_p(s, 1);
+}
+
 void s_signal(uint8_t n) {
-	register SEMAPHORE *s = &_sem[n];
-	uint8_t t;
+	s_signal_n(n, 1);
+}
 
+/*
+ * libere un semaphore depuis une interruption
+ * entre  : semaphore, indicateur de reveil
+ * sortie : sans
+ * description : comme s_signal, sans demander de commutation : si une
+ *               tache est reveillee, *reveil passe a 1. La routine
+ *               d'interruption appelle schedule_isr(reveil) une seule fois
+ *               avant de se terminer, quel que soit le nombre de signaux.
+ */
+void s_signal_from_isr_p(SEMAPHORE *s, uint8_t *reveil) {
 	_lock_();
-
-	if (s->file.fifo_taille == -1)
+	s_verifie_p(s);
+	if (s_libere(s, 1))
 	{
-		printf("Ce sémaphore n'a pas déjà été créer");
-		noyau_exit();
+		*reveil = 1;
 	}
-
-	s->valeur++;
-
-	if (s->valeur <= 0)
-	{
-		fifo_retire(&s->file, (uint8_t *) &t);
-		reveille(t);
-	}
-	_unlock_();	
+	_unlock_();
 }
 
-
-
-
-
+void s_signal_from_isr(uint8_t n, uint8_t *reveil) {
+	_lock_();
+	s_signal_from_isr_p(s_verifie(n), reveil);
+	_unlock_();
+}
@@ -8,23 +8,77 @@
 
 #include <stdint.h>
 
-#include "fifo.h"
+#include "noyau_prio.h"
 
 /*----------------------------------------------------------------------------*
  * declaration des constantes                                                 *
  *----------------------------------------------------------------------------*/
 
-#define MAX_SEM        16
+#define MAX_SEM        16   // au plus 16 : le numero code l'indice sur 4 bits
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+struct ENSEMBLE;
+
+/*
+ * structure definissant un semaphore
+ * une application peut l'allouer elle-meme et l'initialiser par
+ * s_init_static, puis utiliser les fonctions a suffixe _p
+ */
+typedef struct {
+    FILE_ATTENTE file;
+    int32_t valeur;
+    struct ENSEMBLE *ensemble;  // ensemble d'attente (ensemble.h), NULL sinon
+    uint8_t cree;           // 0 si le semaphore est libre
+    uint8_t generation;     // table _sem : generation de l'entree
+    uint8_t suivant_libre;  // table _sem : entree libre suivante
+} SEMAPHORE;
 
 /*----------------------------------------------------------------------------*
  * declaration des prototypes                                                 *
  *----------------------------------------------------------------------------*/
 
+/*
+ * semaphores de la table du noyau, designes par un numero
+ * s_cree prend une entree libre en temps constant ; le numero contient une
+ * generation, un numero ferme est refuse (arret du noyau)
+ */
 void s_init(void);
-uint8_t s_cree(int8_t valeur);
+uint8_t s_cree(int32_t valeur);
 void s_close(uint8_t n);
 void s_wait(uint8_t n);
+uint8_t s_wait_timeout(uint8_t n, uint32_t timeout);
 void s_signal(uint8_t n);
 
-#endif
+/*
+ * s_signal_n libere nb jetons avec une seule commutation
+ * s_signal_from_isr est reservee aux interruptions : elle ne commute pas et
+ * met *reveil a 1 si une tache a ete reveillee ; la routine appelle ensuite
+ * schedule_isr(reveil) une seule fois en sortie
+ *     uint8_t reveil = 0;
+ *     s_signal_from_isr(rx, &reveil);
+ *     s_signal_from_isr(tx, &reveil);
+ *     schedule_isr(reveil);
+ */
+void s_signal_n(uint8_t n, uint32_t nb);
+void s_signal_from_isr(uint8_t n, uint8_t *reveil);
 
+/*
+ * semaphores fournis par l'application : memes fonctions, par adresse ;
+ * attendre un semaphore ferme par s_close_p retourne ATT_DETRUIT, le
+ * signaler arrete le noyau
+ *     static SEMAPHORE plein;
+ *     s_init_static(&plein, 0);
+ *     s_wait_p(&plein);
+ */
+void s_init_static(SEMAPHORE *s, int32_t valeur);
+void s_close_p(SEMAPHORE *s);
+void s_wait_p(SEMAPHORE *s);
+uint8_t s_wait_timeout_p(SEMAPHORE *s, uint32_t timeout);
+void s_signal_p(SEMAPHORE *s);
+void s_signal_n_p(SEMAPHORE *s, uint32_t nb);
+void s_signal_from_isr_p(SEMAPHORE *s, uint8_t *reveil);
+
+#endif
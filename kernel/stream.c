@@ -0,0 +1,135 @@
+/*----------------------------------------------------------------------------*
+ * fichier : stream.c                                                         *
+ * flux d'octets entre un ecrivain et un lecteur, avec seuil de reveil        *
+ *----------------------------------------------------------------------------*/
+
+#include "stream.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * attend sur la file au plus jusqu'a l'echeance
+ * appelee en section critique ; la section critique est relachee pendant
+ * l'attente. L'appelant reverifie sa condition au reveil.
+ * sortie : ATT_OK pour reverifier, ATT_TIMEOUT pour abandonner
+ */
+static uint8_t stream_attend(FILE_ATTENTE *f, uint32_t timeout, uint32_t echeance) {
+	int32_t reste;
+
+	if (timeout != ATT_INFINI) {
+		reste = (int32_t) (echeance - noyau_get_ticks());
+		if (reste <= 0) {
+			return ATT_TIMEOUT;
+		}
+		timeout = reste;
+	}
+	attente(f, timeout);
+	_unlock_();		/* commutation, reprise au reveil */
+	_lock_();
+	return attente_etat();
+}
+
+static uint32_t stream_libre(STREAM *s) {
+	return s->anneau.masque + 1 - anneau_nb(&s->anneau);
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+int stream_init(STREAM *s, void *stockage, uint32_t capacite, uint32_t seuil) {
+	if (seuil == 0 || seuil > capacite
+			|| !anneau_init(&s->anneau, stockage, 1, capacite)) {
+		return 0;
+	}
+	s->seuil = seuil;
+	file_att_init(&s->lecteur);
+	file_att_init(&s->ecrivain);
+	return 1;
+}
+
+int stream_seuil(STREAM *s, uint32_t seuil) {
+	if (seuil == 0 || seuil > s->anneau.masque + 1) {
+		return 0;
+	}
+	_lock_();
+	s->seuil = seuil;
+	if (anneau_nb(&s->anneau) >= seuil
+			&& attente_reveille(&s->lecteur, ATT_OK) != MAX_TACHES_NOYAU) {
+		schedule();
+	}
+	_unlock_();
+	return 1;
+}
+
+uint32_t stream_nb(STREAM *s) {
+	return anneau_nb(&s->anneau);
+}
+
+/*
+ * ecrit des octets dans le flux
+ * description : copie ce qui tient, reveille le lecteur si le seuil est
+ *               atteint, puis attend de la place pour le reste. Le lecteur
+ *               n'est reveille qu'une fois par franchissement du seuil, et
+ *               non a chaque octet.
+ */
+uint32_t stream_ecrit(STREAM *s, const void *data, uint32_t n, uint32_t timeout) {
+	const uint8_t *d = data;
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint32_t total = 0;
+	uint8_t etat = ATT_OK;
+
+	for (;;) {
+		total += anneau_ecrit(&s->anneau, d + total, n - total);
+
+		_lock_();
+		if (anneau_nb(&s->anneau) >= s->seuil
+				&& attente_reveille(&s->lecteur, ATT_OK) != MAX_TACHES_NOYAU) {
+			schedule();
+		}
+		if (total == n || timeout == 0) {
+			_unlock_();
+			return total;
+		}
+		while (stream_libre(s) == 0 && etat == ATT_OK) {
+			etat = stream_attend(&s->ecrivain, timeout, echeance);
+		}
+		_unlock_();
+		if (etat != ATT_OK) {
+			return total;
+		}
+	}
+}
+
+/*
+ * lit des octets du flux
+ * description : attend que le seuil soit atteint, lit puis reveille
+ *               l'ecrivain qui attendait de la place
+ */
+uint32_t stream_lit(STREAM *s, void *data, uint32_t max, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint32_t lus;
+	uint8_t etat = ATT_OK;
+
+	_lock_();
+	while (anneau_nb(&s->anneau) < s->seuil && etat == ATT_OK && timeout) {
+		etat = stream_attend(&s->lecteur, timeout, echeance);
+	}
+	_unlock_();
+
+	lus = anneau_lit(&s->anneau, data, max);
+
+	if (lus) {
+		_lock_();
+		if (attente_reveille(&s->ecrivain, ATT_OK) != MAX_TACHES_NOYAU) {
+			schedule();
+		}
+		_unlock_();
+	}
+	return lus;
+}
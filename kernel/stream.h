@@ -0,0 +1,71 @@
+/*----------------------------------------------------------------------------*
+ * fichier : stream.h                                                         *
+ * flux d'octets entre un ecrivain et un lecteur, avec seuil de reveil        *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include <stdint.h>
+
+#include "anneau.h"
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant un flux
+ * les octets transitent par un anneau sans verrou ; seules les decisions
+ * d'attente et de reveil passent par une section critique. Le lecteur n'est
+ * reveille que lorsqu'au moins seuil octets sont disponibles.
+ */
+typedef struct {
+    ANNEAU anneau;              // octets en transit
+    uint32_t seuil;             // octets necessaires pour reveiller le lecteur
+    FILE_ATTENTE lecteur;       // lecteur en attente de donnees
+    FILE_ATTENTE ecrivain;      // ecrivain en attente de place
+} STREAM;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un flux
+ * entre  : flux, zone de stockage, capacite en octets (puissance de 2),
+ *          seuil de reveil du lecteur (1 a capacite)
+ * sortie : 0 si la capacite ou le seuil sont invalides, 1 sinon
+ */
+int stream_init(STREAM *s, void *stockage, uint32_t capacite, uint32_t seuil);
+
+/*
+ * change le seuil de reveil du lecteur
+ * retourne 0, sans rien changer, si le seuil n'est pas compris entre 1 et
+ * la capacite (le lecteur ne serait jamais reveille), 1 sinon
+ */
+int stream_seuil(STREAM *s, uint32_t seuil);
+
+/*
+ * ecrit n octets, en attendant de la place au plus timeout ticks
+ * (0 : pas d'attente, ATT_INFINI : pas de limite)
+ * retourne le nombre d'octets ecrits ; avec timeout 0, peut etre appelee
+ * en interruption
+ */
+uint32_t stream_ecrit(STREAM *s, const void *data, uint32_t n, uint32_t timeout);
+
+/*
+ * lit au plus max octets ; attend au plus timeout ticks que seuil octets
+ * soient disponibles, puis lit ce qui est present (moins que le seuil si
+ * le delai a expire)
+ * retourne le nombre d'octets lus
+ */
+uint32_t stream_lit(STREAM *s, void *data, uint32_t max, uint32_t timeout);
+
+/*
+ * nombre d'octets disponibles pour le lecteur
+ */
+uint32_t stream_nb(STREAM *s);
+
+#endif
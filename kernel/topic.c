@@ -0,0 +1,123 @@
+/*----------------------------------------------------------------------------*
+ * fichier : topic.c                                                          *
+ * diffusion publication/abonnement sans copie, tampons a compteur de         *
+ * references                                                                 *
+ *----------------------------------------------------------------------------*/
+
+#include "topic.h"
+
+#include "noyau_prio.h"
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * rend une reference ; le tampon revient a la reserve avec la derniere
+ * appelee en section critique
+ */
+static void topic_deref(TOPIC *t, void *tampon) {
+	if (--t->refs[pool_index(t->reserve, tampon)] == 0) {
+		pool_free(t->reserve, tampon);
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+int topic_init(TOPIC *t, POOL *reserve) {
+	uint16_t i;
+
+	// les compteurs sont indexes par pool_index
+	if (reserve->nb > TOPIC_MAX_TAMPONS) {
+		return 0;
+	}
+	t->reserve = reserve;
+	for (i = 0; i < TOPIC_MAX_TAMPONS; i++) {
+		t->refs[i] = 0;
+	}
+	t->nb_abonnes = 0;
+	return 1;
+}
+
+int topic_abonne(TOPIC *t, ABONNE *a, void **stockage, uint16_t profondeur,
+		uint8_t politique) {
+	int ok = 0;
+
+	q_init(&a->file, stockage, sizeof(void *), profondeur);
+	a->politique = politique;
+	a->perdus = 0;
+
+	_lock_();
+	if (t->nb_abonnes < TOPIC_MAX_ABONNES) {
+		t->abonnes[t->nb_abonnes++] = a;
+		ok = 1;
+	}
+	_unlock_();
+	return ok;
+}
+
+/*
+ * prend un tampon libre
+ * sortie : adresse du tampon, 0 si le delai a expire
+ * description : l'editeur detient la premiere reference
+ */
+void *topic_prend(TOPIC *t, uint32_t timeout) {
+	void *p = pool_alloc_timeout(t->reserve, timeout);
+
+	if (p) {
+		t->refs[pool_index(t->reserve, p)] = 1;
+	}
+	return p;
+}
+
+/*
+ * rend une reference sur un tampon
+ * description : le tampon revient a la reserve avec sa derniere reference
+ */
+void topic_rend(TOPIC *t, void *tampon) {
+	_lock_();
+	topic_deref(t, tampon);
+	_unlock_();
+}
+
+/*
+ * publie un tampon
+ * description : chaque abonne recoit une reference ; si sa file est pleine,
+ *               sa politique decide entre perdre le nouveau message et
+ *               rendre le plus ancien. La reference de l'editeur est rendue
+ *               en fin de publication.
+ */
+void topic_publie(TOPIC *t, void *tampon) {
+	uint16_t i = pool_index(t->reserve, tampon);
+	register ABONNE *a;
+	void *ancien;
+	uint8_t k;
+
+	_lock_();
+	for (k = 0; k < t->nb_abonnes; k++) {
+		a = t->abonnes[k];
+		if (!q_try_send_ptr(&a->file, tampon)) {
+			a->perdus++;
+			if (a->politique != TOPIC_ECRASE_ANCIEN
+					|| !q_try_receive(&a->file, &ancien)) {
+				continue;
+			}
+			topic_deref(t, ancien);
+			q_try_send_ptr(&a->file, tampon);
+		}
+		t->refs[i]++;
+	}
+	topic_deref(t, tampon);
+	_unlock_();
+}
+
+void *topic_recoit(ABONNE *a, uint32_t timeout) {
+	void *p;
+
+	if (q_receive_timeout(&a->file, &p, timeout) != ATT_OK) {
+		return 0;
+	}
+	return p;
+}
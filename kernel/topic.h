@@ -0,0 +1,90 @@
+/*----------------------------------------------------------------------------*
+ * fichier : topic.h                                                          *
+ * diffusion publication/abonnement sans copie, tampons a compteur de         *
+ * references                                                                 *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __TOPIC_H__
+#define __TOPIC_H__
+
+#include <stdint.h>
+
+#include "queue.h"
+#include "pool.h"
+
+/*----------------------------------------------------------------------------*
+ * declaration des constantes                                                 *
+ *----------------------------------------------------------------------------*/
+
+#define TOPIC_MAX_TAMPONS    16
+#define TOPIC_MAX_ABONNES    8
+
+/*
+ * politiques d'un abonne dont la file est pleine
+ */
+#define TOPIC_REJETTE_NOUVEAU  0   // le nouveau message est perdu pour cet abonne
+#define TOPIC_ECRASE_ANCIEN    1   // le plus ancien message de sa file est rendu
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * abonne a un sujet : une file de pointeurs sur les tampons publies
+ */
+typedef struct {
+    QUEUE file;                 // tampons recus, non encore lus
+    uint8_t politique;          // TOPIC_REJETTE_NOUVEAU / TOPIC_ECRASE_ANCIEN
+    uint32_t perdus;            // messages perdus par debordement
+} ABONNE;
+
+/*
+ * sujet : une reserve de blocs (pool.h) et la liste des abonnes
+ * un tampon publie est partage par tous les abonnes ; il revient a la
+ * reserve quand le dernier l'a rendu
+ */
+typedef struct {
+    POOL *reserve;                      // tampons, au plus TOPIC_MAX_TAMPONS blocs
+    uint8_t refs[TOPIC_MAX_TAMPONS];    // references sur chaque tampon, 0 si libre
+    uint8_t nb_abonnes;
+    ABONNE *abonnes[TOPIC_MAX_ABONNES];
+} TOPIC;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un sujet
+ * entre  : sujet, reserve initialisee de TOPIC_MAX_TAMPONS blocs au plus ;
+ *          une reserve peut etre partagee par plusieurs sujets
+ * sortie : 0 si la reserve a plus de TOPIC_MAX_TAMPONS blocs, 1 sinon
+ */
+int topic_init(TOPIC *t, POOL *reserve);
+
+/*
+ * abonne une tache au sujet
+ * entre  : sujet, abonne, zone de profondeur pointeurs, profondeur de la
+ *          file, politique de debordement
+ * sortie : 0 si le sujet a deja TOPIC_MAX_ABONNES abonnes, 1 sinon
+ */
+int topic_abonne(TOPIC *t, ABONNE *a, void **stockage, uint16_t profondeur,
+		uint8_t politique);
+
+/*
+ * publication : topic_prend fournit un tampon libre en attendant au plus
+ * timeout ticks (0 si le delai expire), l'editeur le remplit puis le
+ * publie. topic_publie ne copie rien : son cout depend du nombre
+ * d'abonnes, pas de la taille du message. Ne bloque jamais.
+ */
+void *topic_prend(TOPIC *t, uint32_t timeout);
+void topic_publie(TOPIC *t, void *tampon);
+
+/*
+ * reception : topic_recoit attend au plus timeout ticks un tampon publie
+ * (0 si le delai expire) ; l'abonne le lit puis le rend par topic_rend
+ */
+void *topic_recoit(ABONNE *a, uint32_t timeout);
+void topic_rend(TOPIC *t, void *tampon);
+
+#endif
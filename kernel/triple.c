@@ -0,0 +1,131 @@
+/*----------------------------------------------------------------------------*
+ * fichier : triple.c                                                         *
+ * canal "derniere valeur" a triple tampon, sans verrou ni attente            *
+ *----------------------------------------------------------------------------*/
+
+#include "triple.h"
+
+#include "noyau_prio.h"
+#include "noyau_file_prio.h"
+#include "notify.h"
+#include "../hwsupport/stm32h7xx.h"
+
+/*
+ * bit du mot milieu : le tampon du milieu contient une valeur non lue
+ */
+#define TRIPLE_NOUVEAU   0x4
+#define TRIPLE_INDEX     0x3
+
+/*----------------------------------------------------------------------------*
+ * fonctions internes                                                         *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * echange atomique du mot milieu
+ * sortie : ancienne valeur
+ */
+static uint32_t triple_echange(volatile uint32_t *p, uint32_t v) {
+	uint32_t ancien;
+
+	do {
+		ancien = _ldrex(p);
+	} while (_strex(p, v));
+	return ancien;
+}
+
+static void triple_copie(void *d, const void *s, uint16_t n) {
+	register uint8_t *db = d;
+	register const uint8_t *sb = s;
+
+	while (n--) {
+		*db++ = *sb++;
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ * definition des fonctions                                                   *
+ *----------------------------------------------------------------------------*/
+
+void triple_init(TRIPLE *t, void *stockage, uint16_t taille) {
+	t->stockage = stockage;
+	t->taille = taille;
+	t->tache = MAX_TACHES_NOYAU;
+	t->ecr = 0;
+	t->milieu = 1;
+	t->lec = 2;
+}
+
+void triple_reveil(TRIPLE *t, uint16_t tache) {
+	t->tache = tache;
+}
+
+void *triple_ecriture(TRIPLE *t) {
+	return t->stockage + t->ecr * t->taille;
+}
+
+/*
+ * publie le tampon de l'ecrivain
+ * description : la barriere garantit que le contenu est ecrit avant que le
+ *               tampon ne devienne visible ; une valeur non lue du milieu
+ *               est simplement remplacee
+ */
+void triple_publie(TRIPLE *t) {
+	_DMB();
+	t->ecr = triple_echange(&t->milieu, t->ecr | TRIPLE_NOUVEAU) & TRIPLE_INDEX;
+	if (t->tache != MAX_TACHES_NOYAU) {
+		notify(t->tache, 0, NOTIF_SIGNAL);
+	}
+}
+
+void triple_ecrit(TRIPLE *t, const void *valeur) {
+	triple_copie(triple_ecriture(t), valeur, t->taille);
+	triple_publie(t);
+}
+
+const void *triple_lecture(TRIPLE *t, int *nouveau) {
+	int n = (t->milieu & TRIPLE_NOUVEAU) != 0;
+
+	if (n) {
+		t->lec = triple_echange(&t->milieu, t->lec) & TRIPLE_INDEX;
+		_DMB();		/* le contenu est lu apres l'echange */
+	}
+	if (nouveau) {
+		*nouveau = n;
+	}
+	return t->stockage + t->lec * t->taille;
+}
+
+int triple_lit(TRIPLE *t, void *valeur) {
+	int nouveau;
+
+	triple_copie(valeur, triple_lecture(t, &nouveau), t->taille);
+	return nouveau;
+}
+
+/*
+ * attend une valeur nouvelle
+ * entre  : canal, delai maximal en ticks
+ * sortie : ATT_OK ou ATT_TIMEOUT
+ * description : a appeler par la tache donnee a triple_reveil ; la valeur
+ *               est ensuite obtenue par triple_lecture ou triple_lit
+ */
+uint8_t triple_attend(TRIPLE *t, uint32_t timeout) {
+	uint32_t echeance = noyau_get_ticks() + timeout;
+	uint32_t delai = timeout;
+	int32_t reste;
+
+	while (!(t->milieu & TRIPLE_NOUVEAU)) {
+		// une notification sans valeur nouvelle ne prolonge pas l'attente
+		if (timeout != ATT_INFINI) {
+			reste = (int32_t) (echeance - noyau_get_ticks());
+			if (reste <= 0) {
+				return ATT_TIMEOUT;
+			}
+			delai = reste;
+		}
+		if (notify_wait(0, delai, 0) != ATT_OK) {
+			return (t->milieu & TRIPLE_NOUVEAU) ? ATT_OK : ATT_TIMEOUT;
+		}
+	}
+	return ATT_OK;
+}
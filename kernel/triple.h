@@ -0,0 +1,67 @@
+/*----------------------------------------------------------------------------*
+ * fichier : triple.h                                                         *
+ * canal "derniere valeur" a triple tampon, sans verrou ni attente            *
+ *----------------------------------------------------------------------------*/
+
+#ifndef __TRIPLE_H__
+#define __TRIPLE_H__
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ * declaration des structures                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * structure definissant un canal a triple tampon
+ * un ecrivain et un lecteur possedent chacun un tampon ; le troisieme est
+ * echange atomiquement (LDREX/STREX) avec celui de l'ecrivain a chaque
+ * publication et avec celui du lecteur quand une valeur nouvelle est
+ * disponible. L'ecrivain ne bloque jamais, le lecteur obtient toujours le
+ * dernier instantane complet.
+ */
+typedef struct {
+    uint8_t *stockage;          // zone de 3 * taille octets
+    uint16_t taille;            // taille d'un instantane en octets
+    uint16_t tache;             // tache notifiee a chaque publication
+    uint8_t ecr;                // tampon de l'ecrivain
+    uint8_t lec;                // tampon du lecteur
+    volatile uint32_t milieu;   // tampon echange, plus TRIPLE_NOUVEAU
+} TRIPLE;
+
+/*----------------------------------------------------------------------------*
+ * declaration des prototypes                                                 *
+ *----------------------------------------------------------------------------*/
+
+/*
+ * initialise un canal
+ * entre  : canal, zone de 3 * taille octets, taille d'un instantane
+ */
+void triple_init(TRIPLE *t, void *stockage, uint16_t taille);
+
+/*
+ * ecrivain : triple_ecriture donne le tampon a remplir, triple_publie le
+ * rend visible au lecteur. triple_ecrit copie et publie un instantane.
+ */
+void *triple_ecriture(TRIPLE *t);
+void triple_publie(TRIPLE *t);
+void triple_ecrit(TRIPLE *t, const void *valeur);
+
+/*
+ * lecteur : triple_lecture donne le dernier instantane publie ; *nouveau
+ * (si non nul) passe a 1 s'il n'avait pas encore ete lu. Le tampon reste
+ * valide jusqu'a l'appel suivant. triple_lit copie l'instantane et
+ * retourne 1 s'il est nouveau.
+ */
+const void *triple_lecture(TRIPLE *t, int *nouveau);
+int triple_lit(TRIPLE *t, void *valeur);
+
+/*
+ * notification optionnelle : a chaque publication, l'ecrivain notifie la
+ * tache (notify, NOTIF_SIGNAL) ; elle attend une valeur nouvelle par
+ * triple_attend (ATT_OK ou ATT_TIMEOUT). MAX_TACHES_NOYAU : pas de reveil.
+ */
+void triple_reveil(TRIPLE *t, uint16_t tache);
+uint8_t triple_attend(TRIPLE *t, uint32_t timeout);
+
+#endif
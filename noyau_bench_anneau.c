@@ -0,0 +1,131 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_anneau.c                                             *
+ * debit de l'anneau sans verrou, en octets par millier de cycles, compare    *
+ * a la FIFO d'octets protegee par section critique                           *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/fifo.h"
+#include "kernel/anneau.h"
+#include "io/serialio.h"
+
+/* Volume par mesure : la durée totale doit rester inférieure à une période
+ * du Systick.
+ */
+#define NB_OCTETS   8192
+#define CAPACITE    256
+#define BLOC        64      /* taille des transferts par zones */
+
+static ANNEAU anneau;
+static uint8_t stockage[CAPACITE];
+static uint32_t stockage_mots[CAPACITE];
+static uint8_t bloc[BLOC];
+
+/* Durée entre deux lectures du Systick, au plus une période */
+static uint32_t duree(uint32_t t0, uint32_t t1)
+{
+	return (t0 >= t1) ? t0 - t1 : t0 + SYSTICK->load + 1 - t1;
+}
+
+static void affiche(const char *nom, uint32_t cycles)
+{
+	printf("%-34s : %6u octets/kcycle\n", nom, NB_OCTETS * 1000 / cycles);
+}
+
+/* Référence : FIFO d'octets, un _lock_ par octet dans chaque sens */
+static uint32_t mesure_fifo(void)
+{
+	FIFO f;
+	uint8_t c;
+	uint32_t t0;
+
+	fifo_init(&f);
+	t0 = systick_get();
+	for (int i = 0; i < NB_OCTETS; i++) {
+		_lock_();
+		fifo_ajoute(&f, i);
+		_unlock_();
+		_lock_();
+		fifo_retire(&f, &c);
+		_unlock_();
+	}
+	return duree(t0, systick_get());
+}
+
+/* Anneau, un octet à la fois */
+static uint32_t mesure_octet(void)
+{
+	uint8_t c = 0;
+	uint32_t t0;
+
+	anneau_init(&anneau, stockage, 1, CAPACITE);
+	t0 = systick_get();
+	for (int i = 0; i < NB_OCTETS; i++) {
+		anneau_ecrit(&anneau, &c, 1);
+		anneau_lit(&anneau, &c, 1);
+	}
+	return duree(t0, systick_get());
+}
+
+/* Anneau, copie par blocs */
+static uint32_t mesure_bloc(void)
+{
+	uint32_t t0;
+
+	anneau_init(&anneau, stockage, 1, CAPACITE);
+	t0 = systick_get();
+	for (int i = 0; i < NB_OCTETS / BLOC; i++) {
+		anneau_ecrit(&anneau, bloc, BLOC);
+		anneau_lit(&anneau, bloc, BLOC);
+	}
+	return duree(t0, systick_get());
+}
+
+/* Anneau de mots, accès direct aux zones sans copie intermédiaire */
+static uint32_t mesure_zone(void)
+{
+	uint32_t t0, n, m, somme = 0;
+	uint32_t *w;
+	const uint32_t *r;
+
+	anneau_init(&anneau, stockage_mots, 4, CAPACITE);
+	t0 = systick_get();
+	for (int i = 0; i < NB_OCTETS / (4 * BLOC); i++) {
+		n = anneau_zone_ecriture(&anneau, (void **) &w);
+		n = (n > BLOC) ? BLOC : n;
+		for (m = 0; m < n; m++) {
+			w[m] = m;
+		}
+		anneau_publie(&anneau, n);
+		n = anneau_zone_lecture(&anneau, (const void **) &r);
+		for (m = 0; m < n; m++) {
+			somme += r[m];
+		}
+		anneau_libere(&anneau, n);
+	}
+	(void) somme;
+	return duree(t0, systick_get());
+}
+
+TACHE tachedefond(void *arg)
+{
+	puts("Bench anneau SPSC");
+
+	affiche("FIFO + _lock_, octet par octet", mesure_fifo());
+	affiche("anneau, octet par octet", mesure_octet());
+	affiche("anneau, blocs de 64 octets", mesure_bloc());
+	affiche("anneau de mots, zones directes", mesure_zone());
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	start(tachedefond);
+	return(0);
+}
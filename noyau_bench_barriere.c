@@ -0,0 +1,139 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_barriere.c                                           *
+ * cout d'un changement de phase pour un groupe de taches : barriere du       *
+ * noyau contre compteur protege par un mutex et un semaphore par tache       *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/sem.h"
+#include "kernel/mutex.h"
+#include "kernel/barriere.h"
+#include "io/serialio.h"
+
+/* Nombre de phases par mesure : la durée totale doit rester inférieure à
+ * une période du Systick.
+ */
+#define NB_PHASES 50
+#define MAX_TACHES 4
+
+#define MODE_SEM        0
+#define MODE_BARRIERE   1
+
+static SEMAPHORE fin;
+static SEMAPHORE depart[MAX_TACHES];
+static BARRIERE barriere;
+static LOQUET top;
+static volatile int mode;
+
+/* Schéma de référence : compteur d'arrivées sous mutex, la dernière arrivée
+ * signale le sémaphore de chacune des autres tâches.
+ */
+static MUTEX verrou;
+static SEMAPHORE reprise[MAX_TACHES];
+static int arrivees, nb_taches;
+
+static uint32_t debut, duree_tot;
+
+/* Durée entre deux lectures du Systick, au plus une période */
+static uint32_t duree(uint32_t t0, uint32_t t1)
+{
+	return (t0 >= t1) ? t0 - t1 : t0 + SYSTICK->load + 1 - t1;
+}
+
+static void barriere_sem(int id)
+{
+	m_acquire_p(&verrou);
+	if (++arrivees < nb_taches) {
+		m_release_p(&verrou);
+		s_wait_p(&reprise[id]);
+		return;
+	}
+	arrivees = 0;
+	for (int i = 0; i < nb_taches; i++) {
+		if (i != id) {
+			s_signal_p(&reprise[i]);
+		}
+	}
+	m_release_p(&verrou);
+}
+
+/* Les étages sont créés une seule fois (cree() ne réutilise pas les
+ * emplacements). Chaque mesure réveille les nb premiers par leur
+ * sémaphore ; ils attendent ensuite le loquet pour partir ensemble.
+ */
+TACHE etage(void *arg)
+{
+	int id = (int) arg;
+
+	for (;;) {
+		s_wait_p(&depart[id]);
+		loquet_attend(&top, ATT_INFINI);
+		if (id == 0) {
+			debut = systick_get();
+		}
+		for (int i = 0; i < NB_PHASES; i++) {
+			if (mode == MODE_SEM) {
+				barriere_sem(id);
+			} else {
+				barriere_attend(&barriere, ATT_INFINI, NULL);
+			}
+		}
+		if (id == 0) {
+			duree_tot = duree(debut, systick_get());
+		}
+		s_signal_p(&fin);
+	}
+}
+
+/* Relance nb étages de priorité 3 et affiche le coût moyen d'une phase. */
+static void mesure(const char *nom, int m, int nb)
+{
+	mode = m;
+	nb_taches = nb;
+	arrivees = 0;
+	barriere_init(&barriere, nb);
+	loquet_init(&top, 1);
+	for (int i = 0; i < nb; i++) {
+		s_signal_p(&depart[i]);
+	}
+	loquet_decompte(&top);
+	for (int i = 0; i < nb; i++) {
+		s_wait_p(&fin);
+	}
+	printf("%-20s %d taches : %6u cycles/phase\n", nom, nb, duree_tot / NB_PHASES);
+}
+
+TACHE tachedefond(void *arg)
+{
+	puts("Bench barrieres");
+
+	s_init_static(&fin, 0);
+	m_init_static(&verrou, MUTEX_HERITAGE, 0);
+	for (int i = 0; i < MAX_TACHES; i++) {
+		s_init_static(&reprise[i], 0);
+		s_init_static(&depart[i], 0);
+	}
+	for (int i = 0; i < MAX_TACHES; i++) {
+		active(cree(etage, 3, (void *) i));
+	}
+
+	for (int nb = 2; nb <= MAX_TACHES; nb++) {
+		mesure("mutex + semaphores", MODE_SEM, nb);
+		mesure("barriere", MODE_BARRIERE, nb);
+	}
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	s_init();
+	m_init();
+	start(tachedefond);
+	return(0);
+}
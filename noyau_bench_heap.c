@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_heap.c                                               *
+ * latence de heap_alloc / heap_free (TLSF) pour des tailles aleatoires        *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/heap.h"
+#include "io/serialio.h"
+
+#define NB_OPERATIONS   4000
+#define NB_BLOCS        64      /* blocs vivants au plus */
+#define TAILLE_MAX      1024
+
+static void *blocs[NB_BLOCS];
+static uint32_t graine = 12345;
+
+/* Générateur congruentiel : reproductible d'une exécution à l'autre */
+static uint32_t aleatoire(void)
+{
+	graine = graine * 1664525 + 1013904223;
+	return graine >> 8;
+}
+
+/* Durée entre deux lectures du Systick, au plus une période */
+static uint32_t duree(uint32_t t0, uint32_t t1)
+{
+	return (t0 >= t1) ? t0 - t1 : t0 + SYSTICK->load + 1 - t1;
+}
+
+typedef struct {
+	uint32_t nb, min, max, somme;
+} MESURE;
+
+static void ajoute(MESURE *m, uint32_t c)
+{
+	if (m->nb == 0 || c < m->min) m->min = c;
+	if (c > m->max) m->max = c;
+	m->somme += c;
+	m->nb++;
+}
+
+static void affiche(const char *nom, MESURE *m)
+{
+	printf("%-12s : min %5u  moy %5u  max %5u cycles (%u appels)\n",
+			nom, m->min, m->nb ? m->somme / m->nb : 0, m->max, m->nb);
+}
+
+TACHE tachedefond(void *arg)
+{
+	MESURE alloc = {0}, libere = {0};
+	HEAP_STATS s;
+	uint32_t t0, t1, echecs = 0;
+	int i;
+
+	puts("Bench tas TLSF");
+	heap_init();
+
+	for (int n = 0; n < NB_OPERATIONS; n++) {
+		i = aleatoire() % NB_BLOCS;
+		if (blocs[i]) {
+			t0 = systick_get();
+			heap_free(blocs[i]);
+			t1 = systick_get();
+			ajoute(&libere, duree(t0, t1));
+			blocs[i] = 0;
+		} else {
+			uint32_t taille = 1 + aleatoire() % TAILLE_MAX;
+			t0 = systick_get();
+			blocs[i] = heap_alloc(taille);
+			t1 = systick_get();
+			ajoute(&alloc, duree(t0, t1));
+			if (!blocs[i]) echecs++;
+		}
+	}
+
+	affiche("heap_alloc", &alloc);
+	affiche("heap_free", &libere);
+	heap_stats(&s);
+	printf("tas %u octets, utilises %u, pic %u, plus grand libre %u, fragmentation %u %%, echecs %u\n",
+			s.total, s.utilise, s.pic, s.plus_grand_libre, s.fragmentation, echecs);
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	start(tachedefond);
+	return(0);
+}
@@ -0,0 +1,127 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_mutex.c                                              *
+ * cout de m_acquire / m_release selon le protocole du mutex :                *
+ * transmission FIFO seule, heritage de priorite, plafond immediat. Hors      *
+ * plafond, une paire sans contention ne fait qu'un LDREX/STREX dans chaque   *
+ * sens ; la paire s_wait / s_signal sert de reference avec section critique  *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/sem.h"
+#include "kernel/mutex.h"
+#include "io/serialio.h"
+
+/* Nombre de paires acquire/release par mesure : la durée totale doit rester
+ * inférieure à une période du Systick.
+ */
+#define NB_PAIRES 500
+
+static uint8_t sem_fin, sem_ref;
+static uint8_t mutex_a, mutex_b;
+static uint32_t debut, fin;
+
+/* Durée entre deux lectures du Systick, au plus une période */
+static uint32_t duree(uint32_t t0, uint32_t t1)
+{
+	return (t0 >= t1) ? t0 - t1 : t0 + SYSTICK->load + 1 - t1;
+}
+
+/* Paires acquire/release sans contention */
+TACHE simple(void *arg)
+{
+	debut = systick_get();
+	for (int i = 0; i < NB_PAIRES; i++) {
+		m_acquire(mutex_a);
+		m_release(mutex_a);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+/* Référence : sémaphore binaire, toujours en section critique */
+TACHE semaphore(void *arg)
+{
+	debut = systick_get();
+	for (int i = 0; i < NB_PAIRES; i++) {
+		s_wait(sem_ref);
+		s_signal(sem_ref);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+/* Ré-acquisition par le propriétaire : compteur d'imbrication seul */
+TACHE recursif(void *arg)
+{
+	m_acquire(mutex_a);
+	debut = systick_get();
+	for (int i = 0; i < NB_PAIRES; i++) {
+		m_acquire(mutex_a);
+		m_release(mutex_a);
+	}
+	fin = systick_get();
+	m_release(mutex_a);
+	s_signal(sem_fin);
+}
+
+/* Deux mutex imbriqués : la libération du mutex interne doit recalculer la
+ * priorité à partir du mutex externe encore détenu.
+ */
+TACHE imbrique(void *arg)
+{
+	debut = systick_get();
+	for (int i = 0; i < NB_PAIRES; i++) {
+		m_acquire(mutex_a);
+		m_acquire(mutex_b);
+		m_release(mutex_b);
+		m_release(mutex_a);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+/* Lance la tâche de mesure (priorité 3, plafond 2) et affiche le coût
+ * moyen d'une paire acquire/release.
+ */
+static void mesure(const char *nom, uint8_t protocole, TACHE_ADR tache, int paires)
+{
+	mutex_a = m_create_proto(protocole, 2);
+	mutex_b = m_create_proto(protocole, 2);
+	active(cree(tache, 3, 0));
+	s_wait(sem_fin);
+	printf("%-28s : %6u cycles/paire\n", nom, duree(debut, fin) / (NB_PAIRES * paires));
+	m_destroy(mutex_a);
+	m_destroy(mutex_b);
+}
+
+TACHE tachedefond(void *arg)
+{
+	puts("Bench mutex");
+
+	sem_fin = s_cree(0);
+	sem_ref = s_cree(1);
+
+	mesure("semaphore (reference)", MUTEX_AUCUN, semaphore, 1);
+	mesure("FIFO", MUTEX_AUCUN, simple, 1);
+	mesure("heritage", MUTEX_HERITAGE, simple, 1);
+	mesure("plafond", MUTEX_PLAFOND, simple, 1);
+	mesure("heritage, recursif", MUTEX_HERITAGE, recursif, 1);
+	mesure("FIFO, imbriques", MUTEX_AUCUN, imbrique, 2);
+	mesure("heritage, imbriques", MUTEX_HERITAGE, imbrique, 2);
+	mesure("plafond, imbriques", MUTEX_PLAFOND, imbrique, 2);
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	s_init();
+	m_init();
+	start(tachedefond);
+	return(0);
+}
@@ -0,0 +1,52 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_printf.c                                             *
+ * mesure du coût du formatage printf sur des lignes de trace du noyau        *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "io/serialio.h"
+
+/* Nombre d'appels par mesure : la durée totale doit rester inférieure à la
+ * période du Systick (2^24 cycles).
+ */
+#define BENCH_ITER 100
+
+static char ligne[128];
+
+/* Mesure en cycles par appel de snprintf, sans le temps de sortie UART.
+ * Le Systick décompte : la durée écoulée est debut - fin modulo 2^24.
+ */
+#define BENCH(nom, ...) do { \
+	uint32_t debut, fin; \
+	debut = systick_get(); \
+	for (int i = 0; i < BENCH_ITER; i++) { \
+		snprintf(ligne, sizeof(ligne), __VA_ARGS__); \
+	} \
+	fin = systick_get(); \
+	printf("%-24s : %6u cycles/appel  \"%s\"\n", nom, \
+			((debut - fin) & 0x00ffffff) / BENCH_ITER, ligne); \
+} while (0)
+
+int main()
+{
+	usart_init(115200);
+	/* Systick en décompteur libre sur 24 bits, sans interruption */
+	systick_start(0x01000000);
+
+	puts("Bench printf");
+	BENCH("reveille", "reveille : %d\n", 42);
+	BENCH("activations", "\nActivations tache %d : %d", 17, 123456);
+	BENCH("position curseur", "%s%d;%d%s", "\x1B[", 13, 118, "H");
+	BENCH("tick chronogramme", "%c%02d", '|', 9);
+	BENCH("file", "_queue[%d] = %d\n", 3, 8);
+	BENCH("hexa", "pc=%08x psr=%X", 0x000012fc, 0x01000000);
+	BENCH("long", "%ld %lu", -2000000000L, 4000000000UL);
+	BENCH("long long", "%llu", 12345678901234567ULL);
+	BENCH("pointeur", "tcb=%p", (void *) ligne);
+
+	for(;;) continue;
+	return(0);
+}
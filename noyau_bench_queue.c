@@ -0,0 +1,206 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_queue.c                                              *
+ * debit producteur/consommateur : files de messages contre le schema         *
+ * tampon global + paire de semaphores                                        *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/sem.h"
+#include "kernel/queue.h"
+#include "io/serialio.h"
+
+/* Nombre de messages par mesure : la durée totale doit rester inférieure à
+ * une période du Systick.
+ */
+#define NB_MESSAGES 200
+#define PROFONDEUR  8
+#define GROS        256     /* taille des gros tampons en octets */
+
+typedef struct {
+	uint32_t mot[4];
+} MESSAGE;
+
+/* File de messages par copie */
+static QUEUE file;
+static MESSAGE file_stockage[PROFONDEUR];
+
+/* File de pointeurs : les gros tampons circulent sans copie. La file est
+ * moins profonde que le nombre de tampons, le producteur ne réutilise donc
+ * jamais un tampon encore détenu par le consommateur.
+ */
+static QUEUE file_ptr;
+static void *file_ptr_stockage[PROFONDEUR / 2];
+static uint8_t gros_tampons[PROFONDEUR][GROS];
+
+/* Schéma de référence : tampon circulaire global, semaphores vide/plein */
+static uint8_t sem_vide, sem_plein, sem_fin;
+static MESSAGE tampon[PROFONDEUR];
+static uint8_t gros_tampon[PROFONDEUR][GROS];
+
+static uint32_t debut, fin;
+
+static void copie(void *d, const void *s, int n)
+{
+	uint8_t *db = d;
+	const uint8_t *sb = s;
+
+	while (n--) *db++ = *sb++;
+}
+
+/* Durée entre deux lectures du Systick, au plus une période */
+static uint32_t duree(uint32_t t0, uint32_t t1)
+{
+	return (t0 >= t1) ? t0 - t1 : t0 + SYSTICK->load + 1 - t1;
+}
+
+TACHE prod_queue(void *arg)
+{
+	MESSAGE m = {{0}};
+
+	debut = systick_get();
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		m.mot[0] = i;
+		q_send(&file, &m);
+	}
+}
+
+TACHE cons_queue(void *arg)
+{
+	MESSAGE m;
+
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		q_receive(&file, &m);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+TACHE prod_sem(void *arg)
+{
+	MESSAGE m = {{0}};
+	int ecr = 0;
+
+	debut = systick_get();
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		m.mot[0] = i;
+		s_wait(sem_vide);
+		copie(&tampon[ecr], &m, sizeof(m));
+		ecr = (ecr + 1) % PROFONDEUR;
+		s_signal(sem_plein);
+	}
+}
+
+TACHE cons_sem(void *arg)
+{
+	MESSAGE m;
+	int lec = 0;
+
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		s_wait(sem_plein);
+		copie(&m, &tampon[lec], sizeof(m));
+		lec = (lec + 1) % PROFONDEUR;
+		s_signal(sem_vide);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+TACHE prod_ptr(void *arg)
+{
+	uint8_t *p;
+
+	debut = systick_get();
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		p = gros_tampons[i % PROFONDEUR];
+		p[0] = i;
+		q_send_ptr(&file_ptr, p);
+	}
+}
+
+TACHE cons_ptr(void *arg)
+{
+	volatile uint8_t *p;
+
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		p = q_receive_ptr(&file_ptr);
+		(void) p[0];
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+TACHE prod_sem_gros(void *arg)
+{
+	static uint8_t local[GROS];
+	int ecr = 0;
+
+	debut = systick_get();
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		local[0] = i;
+		s_wait(sem_vide);
+		copie(gros_tampon[ecr], local, GROS);
+		ecr = (ecr + 1) % PROFONDEUR;
+		s_signal(sem_plein);
+	}
+}
+
+TACHE cons_sem_gros(void *arg)
+{
+	static uint8_t local[GROS];
+	int lec = 0;
+
+	for (int i = 0; i < NB_MESSAGES; i++) {
+		s_wait(sem_plein);
+		copie(local, gros_tampon[lec], GROS);
+		lec = (lec + 1) % PROFONDEUR;
+		s_signal(sem_vide);
+	}
+	fin = systick_get();
+	s_signal(sem_fin);
+}
+
+/* Lance un couple producteur (priorité 3) / consommateur (priorité 2) et
+ * affiche le coût moyen d'un message.
+ */
+static void mesure(const char *nom, TACHE_ADR prod, TACHE_ADR cons)
+{
+	active(cree(cons, 2, 0));
+	active(cree(prod, 3, 0));
+	s_wait(sem_fin);
+	printf("%-32s : %6u cycles/message\n", nom, duree(debut, fin) / NB_MESSAGES);
+}
+
+TACHE tachedefond(void *arg)
+{
+	puts("Bench files de messages");
+
+	q_init(&file, file_stockage, sizeof(MESSAGE), PROFONDEUR);
+	q_init(&file_ptr, file_ptr_stockage, sizeof(void *), PROFONDEUR / 2);
+	sem_fin = s_cree(0);
+
+	sem_vide = s_cree(PROFONDEUR);
+	sem_plein = s_cree(0);
+	mesure("semaphores + tampon, 16 octets", prod_sem, cons_sem);
+	mesure("file de messages, 16 octets", prod_queue, cons_queue);
+
+	s_close(sem_vide);
+	s_close(sem_plein);
+	sem_vide = s_cree(PROFONDEUR);
+	sem_plein = s_cree(0);
+	mesure("semaphores + tampon, 256 octets", prod_sem_gros, cons_sem_gros);
+	mesure("file de pointeurs, 256 octets", prod_ptr, cons_ptr);
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	s_init();
+	start(tachedefond);
+	return(0);
+}
@@ -0,0 +1,128 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_bench_rwlock.c                                             *
+ * table de configuration lue par plusieurs taches : mutex contre verrou      *
+ * lecteurs/ecrivain. Chaque lecture garde le verrou pendant un tick          *
+ * (lecture lente) ; avec le mutex les lecteurs passent un par un, avec le    *
+ * verrou la duree totale ne depend plus du nombre de lecteurs                *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm32h7xx.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/delay.h"
+#include "kernel/sem.h"
+#include "kernel/mutex.h"
+#include "kernel/rwlock.h"
+#include "io/serialio.h"
+
+#define NB_LECTURES 20      /* lectures par tache lectrice */
+#define MAX_LECTEURS 4
+
+#define MODE_MUTEX  0
+#define MODE_RW     1
+
+static SEMAPHORE fin;
+static SEMAPHORE depart[MAX_LECTEURS + 1];  /* le dernier : ecrivain */
+static MUTEX verrou_m;
+static RWLOCK verrou_rw;
+static volatile uint32_t table[16];
+static volatile int mode;
+
+/* Les tâches sont créées une seule fois (cree() ne réutilise pas les
+ * emplacements) ; chaque mesure relance une série par leur sémaphore.
+ */
+TACHE lecteur(void *arg)
+{
+	int id = (int) arg;
+
+	for (;;) {
+		s_wait_p(&depart[id]);
+		for (int i = 0; i < NB_LECTURES; i++) {
+			if (mode == MODE_MUTEX) {
+				m_acquire_p(&verrou_m);
+			} else {
+				rw_lecture(&verrou_rw, ATT_INFINI);
+			}
+			(void) table[i & 15];
+			delay(1);
+			if (mode == MODE_MUTEX) {
+				m_release_p(&verrou_m);
+			} else {
+				rw_lecture_fin(&verrou_rw);
+			}
+		}
+		s_signal_p(&fin);
+	}
+}
+
+/* Ecrivain de la mesure avec écriture : une mise à jour par lecture d'un
+ * lecteur, servie dès le départ des lecteurs présents (RW_ECRIVAIN).
+ */
+TACHE ecrivain(void *arg)
+{
+	for (;;) {
+		s_wait_p(&depart[MAX_LECTEURS]);
+		for (int i = 0; i < NB_LECTURES; i++) {
+			rw_ecriture(&verrou_rw, ATT_INFINI);
+			table[i & 15] = i;
+			rw_ecriture_fin(&verrou_rw);
+			delay(1);
+		}
+		s_signal_p(&fin);
+	}
+}
+
+/* Relance nb lecteurs (priorité 3) et, si demandé, l'écrivain (priorité 2)
+ * et affiche la durée totale en ticks.
+ */
+static void mesure(const char *nom, int m, int nb, int avec_ecrivain)
+{
+	uint32_t debut = noyau_get_ticks();
+
+	mode = m;
+	for (int i = 0; i < nb; i++) {
+		s_signal_p(&depart[i]);
+	}
+	if (avec_ecrivain) {
+		s_signal_p(&depart[MAX_LECTEURS]);
+	}
+	for (int i = 0; i < nb + avec_ecrivain; i++) {
+		s_wait_p(&fin);
+	}
+	printf("%-24s %d lecteurs : %4u ticks\n", nom, nb, noyau_get_ticks() - debut);
+}
+
+TACHE tachedefond(void *arg)
+{
+	puts("Bench verrou lecteurs/ecrivain");
+
+	s_init_static(&fin, 0);
+	m_init_static(&verrou_m, MUTEX_HERITAGE, 0);
+	rw_init(&verrou_rw, RW_ECRIVAIN);
+	for (int i = 0; i <= MAX_LECTEURS; i++) {
+		s_init_static(&depart[i], 0);
+	}
+	for (int i = 0; i < MAX_LECTEURS; i++) {
+		active(cree(lecteur, 3, (void *) i));
+	}
+	active(cree(ecrivain, 2, 0));
+
+	for (int nb = 1; nb <= MAX_LECTEURS; nb++) {
+		mesure("mutex", MODE_MUTEX, nb, 0);
+		mesure("lecteurs/ecrivain", MODE_RW, nb, 0);
+		mesure("lecteurs/ecrivain + ecr", MODE_RW, nb, 1);
+	}
+
+	noyau_exit();
+}
+
+int main()
+{
+	usart_init(115200);
+	s_init();
+	m_init();
+	start(tachedefond);
+	return(0);
+}
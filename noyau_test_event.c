@@ -0,0 +1,100 @@
+/*----------------------------------------------------------------------------*
+ * fichier : noyau_test_event.c                                               *
+ * programme de test des groupes de drapeaux d'evenements                     *
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hwsupport/stm_uart.h"
+#include "kernel/noyau_prio.h"
+#include "kernel/delay.h"
+#include "kernel/event.h"
+#include "io/serialio.h"
+
+/* Drapeaux du groupe */
+#define EV_CAPTEUR_A   0x01
+#define EV_CAPTEUR_B   0x02
+#define EV_ARRET       0x80
+
+uint8_t groupe;
+
+/* tacheCapteur
+ *
+ * Lève périodiquement le drapeau passé en paramètre. Le drapeau reste levé
+ * même si personne ne l'attend encore.
+ *
+ */
+TACHE tacheCapteur(void *arg)
+{
+	uint32_t drapeau = (uint32_t) arg;
+
+	while (1) {
+		delay(drapeau == EV_CAPTEUR_A ? 3 : 5);
+		ev_set(groupe, drapeau);
+	}
+}
+
+/* tacheFusion
+ *
+ * Attend que les deux capteurs aient produit une mesure (EV_ET), les
+ * drapeaux sont baissés en sortie.
+ *
+ */
+TACHE tacheFusion(void *arg)
+{
+	uint32_t obtenus;
+
+	while (1) {
+		ev_wait(groupe, EV_CAPTEUR_A | EV_CAPTEUR_B, EV_ET | EV_EFFACE,
+				ATT_INFINI, &obtenus);
+		printf("fusion : drapeaux %x, ticks %u\n", obtenus, noyau_get_ticks());
+	}
+}
+
+/* tacheSurveillance
+ *
+ * Attend un drapeau quelconque, sans l'effacer, avec un délai : elle est
+ * réveillée par le même ev_set que tacheFusion.
+ *
+ */
+TACHE tacheSurveillance(void *arg)
+{
+	uint32_t obtenus;
+
+	while (1) {
+		if (ev_wait(groupe, EV_CAPTEUR_B | EV_ARRET, EV_OU, 10, &obtenus) != ATT_OK) {
+			puts("surveillance : capteur B muet");
+			continue;
+		}
+		if (obtenus & EV_ARRET) {
+			noyau_exit();
+		}
+		delay(1);
+	}
+}
+
+TACHE	tachedefond(void *arg)
+{
+	puts("------> EXEC tache de fond");
+
+	groupe = ev_cree(0);
+	active(cree(tacheFusion, 1, 0));
+	active(cree(tacheSurveillance, 2, 0));
+	active(cree(tacheCapteur, 3, (void*) EV_CAPTEUR_A));
+	active(cree(tacheCapteur, 4, (void*) EV_CAPTEUR_B));
+
+	while (!usart_read()) {
+	}
+	ev_set(groupe, EV_ARRET);
+	while (1);
+}
+
+int main()
+{
+	usart_init(115200);
+	puts("Test groupes d'evenements");
+	ev_init();
+	start(tachedefond);
+	return(0);
+}
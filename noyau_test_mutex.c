@@ -12,6 +12,7 @@
 #include "io/serialio.h"
 #include "io/TERMINAL.h"
 #include "kernel/mutex.h"
+#include "kernel/klog.h"
 
 uint8_t mutex;
 
@@ -85,6 +86,8 @@ TACHE	tachedefond(void *arg)
 	active(cree(tacheMutex, 2, (void*) &params[0]));
 	active(cree(tacheAutre, 4,  (void*) &params[1]));
 	active(cree(tacheMutex, 6,  (void*) &params[2]));
+	/* Affichage différé des traces du noyau */
+	active(cree(klog_tache, 7, 0));
 
 	while(1);
 	//usart_read();
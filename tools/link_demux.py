@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Demultiplexeur hote de la liaison serie multiplexee (io/link.h).
+
+Lit le flux de trames COBS emis par la cible (port serie, fichier ou entree
+standard), verifie le CRC16 et repartit les canaux :
+  - LOG   : texte, recopie sur la sortie standard ;
+  - TRACE : trace de l'ordonnanceur, une ligne "tick tache sep" par evenement
+            dans le fichier donne par --trace ;
+  - CMD   : reponses aux commandes, prefixees par "cmd> " ;
+  - STATS : compteurs emises/perdues par canal, sur la sortie d'erreur.
+
+Exemples :
+  qemu-system-arm ... -serial stdio | tools/link_demux.py --trace trace.txt
+  tools/link_demux.py /dev/ttyUSB0 --cmd "status"      (necessite pyserial)
+"""
+
+import argparse
+import struct
+import sys
+
+LOG, TRACE, CMD, STATS = range(4)
+NOMS = ["log", "trace", "cmd", "stats"]
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def trame(canal, donnees):
+    brut = bytes([canal]) + donnees
+    return cobs_encode(brut + struct.pack("<H", crc16(brut))) + b"\0"
+
+
+def decode(trame_cobs):
+    brut = cobs_decode(trame_cobs)
+    if brut is None or len(brut) < 3:
+        return None
+    if crc16(brut[:-2]) != struct.unpack("<H", brut[-2:])[0]:
+        return None
+    return brut[0], brut[1:-2]
+
+
+class Demux:
+    def __init__(self, trace):
+        self.trace = trace
+        self.erreurs = 0
+        self.tampon = bytearray()
+
+    def nourrit(self, octets):
+        self.tampon += octets
+        while True:
+            fin = self.tampon.find(b"\0")
+            if fin < 0:
+                return
+            brut, self.tampon = bytes(self.tampon[:fin]), self.tampon[fin + 1:]
+            if brut:
+                self.distribue(brut)
+
+    def distribue(self, brut):
+        res = decode(brut)
+        if res is None:
+            self.erreurs += 1
+            return
+        canal, donnees = res
+        if canal == LOG:
+            sys.stdout.write(donnees.decode("utf-8", "replace"))
+            sys.stdout.flush()
+        elif canal == TRACE and len(donnees) >= 6:
+            tache, sep, tick = struct.unpack("<BcI", donnees[:6])
+            if self.trace:
+                self.trace.write("%d %d %s\n" % (tick, tache, sep.decode()))
+        elif canal == CMD:
+            sys.stdout.write("cmd> " + donnees.decode("utf-8", "replace"))
+            sys.stdout.flush()
+        elif canal == STATS:
+            n = len(donnees) // 8
+            valeurs = struct.unpack("<%dI" % (2 * n), donnees[:8 * n])
+            stats = ", ".join("%s %d/%d" % (NOMS[i] if i < len(NOMS) else i,
+                                            valeurs[2 * i], valeurs[2 * i + 1])
+                              for i in range(n))
+            sys.stderr.write("stats (emises/perdues) : %s\n" % stats)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__,
+                                formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("source", nargs="?", help="port serie ou fichier (defaut : stdin)")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--trace", help="fichier de sortie de la trace")
+    p.add_argument("--cmd", action="append", default=[],
+                   help="commande a envoyer sur le canal CMD (port serie seulement)")
+    args = p.parse_args()
+
+    trace = open(args.trace, "w") if args.trace else None
+    demux = Demux(trace)
+    port = None
+    if args.source is None:
+        lire = sys.stdin.buffer.read1 if hasattr(sys.stdin.buffer, "read1") else sys.stdin.buffer.read
+    elif args.source.startswith("/dev/"):
+        import serial
+        port = serial.Serial(args.source, args.baud, timeout=0.1)
+        lire = lambda: port.read(256)
+    else:
+        f = open(args.source, "rb")
+        lire = lambda: f.read(4096)
+
+    if port:
+        for c in args.cmd:
+            port.write(trame(CMD, (c + "\n").encode()))
+
+    try:
+        while True:
+            octets = lire(4096) if args.source is None else lire()
+            if not octets:
+                if port:
+                    continue
+                break
+            demux.nourrit(octets)
+    except KeyboardInterrupt:
+        pass
+    if demux.erreurs:
+        sys.stderr.write("%d trames invalides\n" % demux.erreurs)
+
+
+if __name__ == "__main__":
+    main()